@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// shared pieces of the hft_bench suites
+//  - every heap allocation in the process is counted (BenchMain.cpp replaces operator new)
+//  - run() warms up once over the inputs, then times `rounds` passes and prints ns/op and allocs/op
+namespace bench
+{
+    struct Options
+    {
+        // only suites/cases whose name contains this run
+        std::string filter;
+        // recorded depth5 frames, one raw frame per line, generated when empty
+        std::string framesPath;
+        int rounds = 50;
+        // decoder checks only, no timing
+        bool checkOnly = false;
+    };
+
+    uint64_t allocations();
+    // bytes requested from operator new so far, frees are not subtracted
+    uint64_t allocatedBytes();
+
+    inline void report(const char *name, double ops, double ns, uint64_t allocs, double checksum)
+    {
+        std::printf("%-34s %10.1f ns/op %8.2f allocs/op %12.0f op/s  (checksum %.2f)\n",
+                    name, ns / ops, static_cast<double>(allocs) / ops, ops / (ns * 1e-9), checksum);
+    }
+
+    inline bool selected(const Options &options, const char *name)
+    {
+        return options.filter.empty() || std::string(name).find(options.filter) != std::string::npos;
+    }
+
+    // fn(input) is one operation, its return value feeds a checksum so nothing gets optimized away
+    template <typename T, typename Fn>
+    void run(const Options &options, const char *name, const std::vector<T> &inputs, int rounds, Fn &&fn)
+    {
+        if (!selected(options, name) || inputs.empty())
+            return;
+
+        double checksum = 0.0;
+        for (const auto &in : inputs)
+            checksum += fn(in);
+
+        const uint64_t allocBefore = allocations();
+        const auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r)
+        {
+            for (const auto &in : inputs)
+                checksum += fn(in);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const uint64_t allocs = allocations() - allocBefore;
+
+        const double ops = static_cast<double>(inputs.size()) * rounds;
+        report(name, ops, std::chrono::duration<double, std::nano>(elapsed).count(), allocs, checksum);
+    }
+
+    // every decoder against a reference on the same frames, false after printing the first mismatch
+    bool checkDecoders(const Options &options);
+    void runDecodeBenchmarks(const Options &options);
+    void runStrategyBenchmarks(const Options &options);
+    void runOrderBenchmarks(const Options &options);
+    void runOrderStoreBenchmarks(const Options &options);
+    void runLogBenchmarks(const Options &options);
+    void runTransportBenchmarks(const Options &options);
+}
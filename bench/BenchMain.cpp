@@ -0,0 +1,74 @@
+#include <BenchHarness.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// hot-path microbenchmarks
+// usage: hft_bench [--filter name] [--frames recorded_depth5_frames.txt] [--rounds n] [--check]
+//  - the decoder checks run first and fail the run with exit code 1; --check runs only them
+
+static std::atomic<uint64_t> allocationCount{0};
+static std::atomic<uint64_t> allocationBytes{0};
+
+void *operator new(std::size_t n)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(n, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t n)
+{
+    return operator new(n);
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+uint64_t bench::allocations()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t bench::allocatedBytes()
+{
+    return allocationBytes.load(std::memory_order_relaxed);
+}
+
+int main(int argc, char **argv)
+{
+    bench::Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            options.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            options.framesPath = argv[++i];
+        else if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+            options.rounds = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--check") == 0)
+            options.checkOnly = true;
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--filter name] [--frames file] [--rounds n] [--check]\n";
+            return 1;
+        }
+    }
+
+    if (!bench::checkDecoders(options))
+        return 1;
+    if (options.checkOnly)
+        return 0;
+
+    bench::runDecodeBenchmarks(options);
+    bench::runStrategyBenchmarks(options);
+    bench::runOrderBenchmarks(options);
+    bench::runOrderStoreBenchmarks(options);
+    bench::runLogBenchmarks(options);
+    bench::runTransportBenchmarks(options);
+    return 0;
+}
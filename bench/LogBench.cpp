@@ -0,0 +1,66 @@
+#include <BenchHarness.hpp>
+#include <Fixed.hpp>
+#include <Log.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// cost on the calling thread of one log line: a flushed ostream write, the way the order path
+// used to print, against HFT_LOG_* into the thread's ring
+//  - the log runs with its writer thread draining to /dev/null, so the numbers include the
+//    cache traffic of a ring that is being consumed; on a single cpu they also include the
+//    writer's own time, which a spare core takes off the caller
+//  - the ring is sized so nothing is dropped during the timed passes
+
+namespace
+{
+    // stand-in for the order.place text the order path prints
+    const std::string SampleMessage =
+        R"({"id":"client_1234","method":"order.place","params":{"symbol":"BTCUSDT","side":"BUY","type":"LIMIT",)"
+        R"("timeInForce":"GTC","quantity":"0.0650","price":"43250.10","newClientOrderId":"client_1234"}})";
+}
+
+void bench::runLogBenchmarks(const Options &options)
+{
+    if (!selected(options, "log/"))
+        return;
+
+    std::vector<int64_t> ids(1000);
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        ids[i] = static_cast<int64_t>(i);
+    const Fixed quantity = Fixed::fromUnits(6500000);
+    const Fixed price = Fixed::fromUnits(4325010000000);
+
+    std::ofstream devNull("/dev/null");
+    run(options, "log/ostream fill line + endl", ids, options.rounds, [&](int64_t id)
+        {
+        devNull << "RiskManager " << id << " fill " << quantity << " at " << price << " position in BTCUSDT" << std::endl;
+        return 1.0; });
+    run(options, "log/ostream order text + endl", ids, options.rounds, [&](int64_t)
+        {
+        devNull << "Sending order: " << SampleMessage << std::endl;
+        return 1.0; });
+
+    Log::Options logOptions;
+    logOptions.path = "/dev/null";
+    logOptions.console = false;
+    logOptions.threadBufferBytes = std::size_t(64) << 20;
+    Log::start(logOptions);
+    const uint64_t droppedBefore = Log::dropped();
+
+    run(options, "log/HFT_LOG_INFO fill line", ids, options.rounds, [&](int64_t id)
+        {
+        HFT_LOG_INFO("RiskManager {} fill {} at {} position in {}", id, quantity, price, "BTCUSDT");
+        return 1.0; });
+    run(options, "log/HFT_LOG_INFO order text", ids, options.rounds, [&](int64_t)
+        {
+        HFT_LOG_INFO("Sending order: {}", SampleMessage);
+        return 1.0; });
+    run(options, "log/HFT_LOG_DEBUG compiled out", ids, options.rounds, [&](int64_t id)
+        {
+        HFT_LOG_DEBUG("RiskManager {} fill {} at {}", id, quantity, price);
+        return 1.0; });
+
+    Log::stop();
+    std::printf("%-34s %10llu records dropped\n", "log/", static_cast<unsigned long long>(Log::dropped() - droppedBefore));
+}
@@ -0,0 +1,639 @@
+#include <BenchHarness.hpp>
+#include <BookTickerParser.hpp>
+#include <Depth5Parser.hpp>
+#include <DepthDiffParser.hpp>
+#include <MarketData.hpp>
+#include <SbeParser.hpp>
+#include <SbeWriter.hpp>
+#include <SnapshotSource.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// market data decode: legacy nlohmann + std::stod depth5 path vs Depth5Parser, the diff and
+// bookTicker parsers on the same price series, the SBE decoders on the same books transcoded to
+// binary, and MarketData::processFrame end to end
+
+namespace
+{
+    // same layout fstream.binance.com sends on the combined stream
+    std::vector<std::string> generateFrames(std::size_t count)
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> tick(-0.5, 0.5);
+        std::uniform_real_distribution<double> qty(0.001, 12.0);
+        const char *names[] = {"btcusdt", "ethusdt"};
+        double mids[] = {43250.10, 2290.35};
+        double ticks[] = {0.10, 0.01};
+
+        std::vector<std::string> frames;
+        frames.reserve(count);
+        char num[64];
+        uint64_t updateId = 3900000000ull;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int s = static_cast<int>(i & 1);
+            mids[s] += tick(rng) * ticks[s] * 10;
+            std::string f = "{\"stream\":\"";
+            f += names[s];
+            f += "@depth5\",\"data\":{\"e\":\"depthUpdate\",\"E\":1700000000123,\"T\":1700000000120,\"s\":\"";
+            for (const char *c = names[s]; *c; ++c)
+                f += static_cast<char>(*c - 'a' + 'A');
+            f += "\",\"U\":" + std::to_string(updateId) + ",\"u\":" + std::to_string(updateId + 40) +
+                 ",\"pu\":" + std::to_string(updateId - 1);
+            updateId += 41;
+            for (int side = 0; side < 2; ++side)
+            {
+                f += side == 0 ? ",\"b\":[" : ",\"a\":[";
+                for (int l = 0; l < 5; ++l)
+                {
+                    double px = mids[s] + (side == 0 ? -(l + 1) : (l + 1)) * ticks[s];
+                    std::snprintf(num, sizeof(num), "%s[\"%.2f\",\"%.3f\"]", l ? "," : "", px, qty(rng));
+                    f += num;
+                }
+                f += "]";
+            }
+            f += "}}";
+            frames.push_back(std::move(f));
+        }
+        return frames;
+    }
+
+    // bookTicker frames for the same two symbols
+    std::vector<std::string> generateTickerFrames(std::size_t count)
+    {
+        std::mt19937_64 rng(7);
+        std::uniform_real_distribution<double> tick(-0.5, 0.5);
+        std::uniform_real_distribution<double> qty(0.001, 12.0);
+        const char *names[] = {"btcusdt", "ethusdt"};
+        const char *upper[] = {"BTCUSDT", "ETHUSDT"};
+        double mids[] = {43250.10, 2290.35};
+        double ticks[] = {0.10, 0.01};
+
+        std::vector<std::string> frames;
+        frames.reserve(count);
+        char buf[512];
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int s = static_cast<int>(i & 1);
+            mids[s] += tick(rng) * ticks[s] * 10;
+            std::snprintf(buf, sizeof(buf),
+                          "{\"stream\":\"%s@bookTicker\",\"data\":{\"e\":\"bookTicker\",\"u\":%zu,\"E\":1700000000123,"
+                          "\"T\":1700000000120,\"s\":\"%s\",\"b\":\"%.2f\",\"B\":\"%.3f\",\"a\":\"%.2f\",\"A\":\"%.3f\"}}",
+                          names[s], 400900217 + i, upper[s], mids[s] - ticks[s], qty(rng), mids[s] + ticks[s], qty(rng));
+            frames.emplace_back(buf);
+        }
+        return frames;
+    }
+
+    // the generated frames quote 0.01 price ticks and 0.001 lots
+    constexpr int8_t PriceExponent = -2;
+    constexpr int8_t QtyExponent = -3;
+
+    // false when the level is finer than the exponents, such a book cannot be sent as is
+    bool toMantissas(const PriceLevel &level, SbeWriter::Level &out)
+    {
+        constexpr int64_t PriceUnits = 1000000;
+        constexpr int64_t QtyUnits = 100000;
+        out = {level.price.units / PriceUnits, level.quantity.units / QtyUnits};
+        return level.price.units % PriceUnits == 0 && level.quantity.units % QtyUnits == 0;
+    }
+
+    bool toMantissas(const std::vector<PriceLevel> &levels, std::vector<SbeWriter::Level> &out)
+    {
+        out.resize(levels.size());
+        for (std::size_t i = 0; i < levels.size(); ++i)
+        {
+            if (!toMantissas(levels[i], out[i]))
+                return false;
+        }
+        return true;
+    }
+
+    // the same books as SBE depth snapshots and diffs, through the json parsers and back out;
+    // sources[i] is the json frame behind snapshots[i] and diffs[i]
+    struct TranscodedDepth
+    {
+        std::vector<std::string> snapshots;
+        std::vector<std::string> diffs;
+        std::vector<std::size_t> sources;
+    };
+
+    TranscodedDepth transcodeDepth(const std::vector<std::string> &frames, const SymbolRegistry &registry)
+    {
+        TranscodedDepth out;
+        DepthDiff diff;
+        std::vector<SbeWriter::Level> bids;
+        std::vector<SbeWriter::Level> asks;
+        for (std::size_t i = 0; i < frames.size(); ++i)
+        {
+            const std::string &f = frames[i];
+            // a snapshot needs both sides
+            if (!DepthDiffParser::parse(f.data(), f.size(), registry, diff) || diff.bids.empty() || diff.asks.empty() ||
+                !toMantissas(diff.bids, bids) || !toMantissas(diff.asks, asks))
+                continue;
+            const std::string &symbol = registry.name(diff.symbol);
+            std::string frame;
+            SbeWriter::depthSnapshot(frame, symbol, 1700000000123000, diff.lastUpdateId, PriceExponent, QtyExponent,
+                                     bids.data(), static_cast<uint16_t>(bids.size()), asks.data(), static_cast<uint16_t>(asks.size()));
+            out.snapshots.push_back(frame);
+            SbeWriter::depthDiff(frame, symbol, 1700000000123000, diff.firstUpdateId, diff.lastUpdateId, PriceExponent,
+                                 QtyExponent, bids.data(), static_cast<uint16_t>(bids.size()), asks.data(),
+                                 static_cast<uint16_t>(asks.size()));
+            out.diffs.push_back(std::move(frame));
+            out.sources.push_back(i);
+        }
+        return out;
+    }
+
+    std::vector<std::string> transcodeTickers(const std::vector<std::string> &tickers, const SymbolRegistry &registry,
+                                              std::vector<std::size_t> *sources = nullptr)
+    {
+        std::vector<std::string> out;
+        MarketData::TopOfBook tob;
+        SbeWriter::Level bid;
+        SbeWriter::Level ask;
+        for (std::size_t i = 0; i < tickers.size(); ++i)
+        {
+            const std::string &f = tickers[i];
+            if (!BookTickerParser::parse(f.data(), f.size(), registry, tob) || !toMantissas(tob.bid, bid) ||
+                !toMantissas(tob.ask, ask))
+                continue;
+            std::string frame;
+            SbeWriter::bestBidAsk(frame, registry.name(tob.symbol), 1700000000123000, tob.updateId, PriceExponent,
+                                  QtyExponent, bid, ask);
+            out.push_back(std::move(frame));
+            if (sources)
+                sources->push_back(i);
+        }
+        return out;
+    }
+
+    template <typename A, typename B>
+    bool sameLevels(const A &a, const B &b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].price != b[i].price || a[i].quantity != b[i].quantity)
+                return false;
+        }
+        return true;
+    }
+
+    bool sameLevel(const PriceLevel &a, const PriceLevel &b)
+    {
+        return a.price == b.price && a.quantity == b.quantity;
+    }
+
+    bool sameBook(const OrderBook &a, const OrderBook &b)
+    {
+        if (a.lastUpdateId != b.lastUpdateId || a.bidDepth() != b.bidDepth() || a.askDepth() != b.askDepth())
+            return false;
+        for (std::size_t i = 0; i < a.bidDepth(); ++i)
+        {
+            if (!sameLevel(a.bid(i), b.bid(i)))
+                return false;
+        }
+        for (std::size_t i = 0; i < a.askDepth(); ++i)
+        {
+            if (!sameLevel(a.ask(i), b.ask(i)))
+                return false;
+        }
+        return true;
+    }
+
+    // /depth bodies held in memory, one per symbol
+    class MemorySnapshots : public SnapshotSource
+    {
+    public:
+        std::unordered_map<std::string, std::string> bodies;
+
+        bool fetch(const std::string &symbol, std::string &body) override
+        {
+            auto it = bodies.find(symbol);
+            if (it == bodies.end())
+                return false;
+            body = it->second;
+            return true;
+        }
+    };
+
+    std::string snapshotBody(int64_t lastUpdateId, const std::vector<PriceLevel> &bids, const std::vector<PriceLevel> &asks)
+    {
+        std::ostringstream os;
+        os << "{\"lastUpdateId\":" << lastUpdateId;
+        const char *names[] = {",\"bids\":[", ",\"asks\":["};
+        const std::vector<PriceLevel> *sides[] = {&bids, &asks};
+        for (int side = 0; side < 2; ++side)
+        {
+            os << names[side];
+            for (std::size_t i = 0; i < sides[side]->size(); ++i)
+                os << (i ? ",[\"" : "[\"") << (*sides[side])[i].price << "\",\"" << (*sides[side])[i].quantity << "\"]";
+            os << "]";
+        }
+        os << "}";
+        return os.str();
+    }
+
+    std::vector<std::string> loadFrames(const char *path)
+    {
+        std::vector<std::string> frames;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (!line.empty())
+                frames.push_back(line);
+        }
+        return frames;
+    }
+
+    // the heap-backed update and decode MarketData::onRead used before Depth5Parser
+    struct LegacyLevel
+    {
+        double price;
+        double quantity;
+    };
+
+    struct LegacyUpdate
+    {
+        std::string symbol;
+        std::vector<LegacyLevel> bids;
+        std::vector<LegacyLevel> asks;
+
+        double midPrice() const { return (bids[0].price + asks[0].price) * 0.5; }
+    };
+
+    void legacyDecode(const std::string &frameBytes, LegacyUpdate &update)
+    {
+        std::string payload = frameBytes;
+        auto parseJson = nlohmann::json::parse(payload);
+        auto stream = parseJson["stream"].get<std::string>();
+        auto data = parseJson["data"];
+        auto sym = stream.substr(0, stream.find('@'));
+        std::transform(sym.begin(), sym.end(), sym.begin(), ::toupper);
+
+        update = LegacyUpdate{};
+        update.symbol = sym;
+        auto bids = data["b"];
+        for (int i = 0; i < std::min(5, (int)bids.size()); ++i)
+        {
+            auto bid = bids[i];
+            update.bids.push_back({std::stod(bid[0].get<std::string>()), std::stod(bid[1].get<std::string>())});
+        }
+        auto asks = data["a"];
+        for (int i = 0; i < std::min(5, (int)asks.size()); ++i)
+        {
+            auto ask = asks[i];
+            update.asks.push_back({std::stod(ask[0].get<std::string>()), std::stod(ask[1].get<std::string>())});
+        }
+    }
+}
+
+namespace
+{
+    // frames from --frames, or generated
+    std::vector<std::string> depthFrames(const bench::Options &options)
+    {
+        return options.framesPath.empty() ? generateFrames(10000) : loadFrames(options.framesPath.c_str());
+    }
+
+    // SBE diffs rebuilt from the json ones, chained per symbol (U = previous u + 1) the way the spot
+    // stream does it; per symbol the first diff has both sides, then every third only bids and
+    // every third only asks; expected[i] is
+    // what parseDepthDiff must give back for frames[i]
+    void chainDiffs(const std::vector<std::string> &json, const SymbolRegistry &registry,
+                    std::vector<std::string> &frames, std::vector<DepthDiff> &expected)
+    {
+        std::vector<int64_t> last(registry.size(), 0);
+        std::vector<std::size_t> count(registry.size(), 0);
+        std::vector<SbeWriter::Level> bids;
+        std::vector<SbeWriter::Level> asks;
+        DepthDiff diff;
+        for (const auto &f : json)
+        {
+            if (!DepthDiffParser::parse(f.data(), f.size(), registry, diff) || !toMantissas(diff.bids, bids) ||
+                !toMantissas(diff.asks, asks))
+                continue;
+            const std::size_t n = count[diff.symbol]++;
+            if (n % 3 == 1)
+            {
+                diff.asks.clear();
+                asks.clear();
+            }
+            else if (n % 3 == 2)
+            {
+                diff.bids.clear();
+                bids.clear();
+            }
+            const int64_t span = diff.lastUpdateId - diff.firstUpdateId;
+            diff.firstUpdateId = last[diff.symbol] == 0 ? diff.firstUpdateId : last[diff.symbol] + 1;
+            diff.lastUpdateId = diff.firstUpdateId + span;
+            diff.prevUpdateId = -1;
+            last[diff.symbol] = diff.lastUpdateId;
+            std::string frame;
+            SbeWriter::depthDiff(frame, registry.name(diff.symbol), 1700000000123000, diff.firstUpdateId,
+                                 diff.lastUpdateId, PriceExponent, QtyExponent, bids.data(),
+                                 static_cast<uint16_t>(bids.size()), asks.data(), static_cast<uint16_t>(asks.size()));
+            frames.push_back(std::move(frame));
+            expected.push_back(diff);
+        }
+    }
+
+    void applyDiff(OrderBook &book, const DepthDiff &diff)
+    {
+        for (const auto &level : diff.bids)
+            book.updateBid(level.price, level.quantity);
+        for (const auto &level : diff.asks)
+            book.updateAsk(level.price, level.quantity);
+        book.lastUpdateId = diff.lastUpdateId;
+    }
+
+    // legacy nlohmann + std::stod and Depth5Parser agree on every level
+    bool checkDepth5(const std::vector<std::string> &frames, const SymbolRegistry &registry)
+    {
+        LegacyUpdate legacy;
+        MarketData::Update update;
+        for (const auto &f : frames)
+        {
+            legacyDecode(f, legacy);
+            if (!Depth5Parser::parse(f.data(), f.size(), registry, update) || registry.name(update.symbol) != legacy.symbol ||
+                legacy.bids.size() != update.bids.size() || legacy.asks.size() != update.asks.size())
+            {
+                std::cerr << "depth5 mismatch on frame: " << f << "\n";
+                return false;
+            }
+            for (std::size_t i = 0; i < legacy.bids.size(); ++i)
+            {
+                // units / 1e8 is one correctly rounded division, so it has to land on the same double as stod
+                if (legacy.bids[i].price != update.bids[i].price.toDouble() || legacy.bids[i].quantity != update.bids[i].quantity.toDouble() ||
+                    legacy.asks[i].price != update.asks[i].price.toDouble() || legacy.asks[i].quantity != update.asks[i].quantity.toDouble())
+                {
+                    std::cerr << "depth5 level mismatch on frame: " << f << "\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // SBE depth snapshots against Depth5Parser on the json they were built from
+    bool checkSbeSnapshots(const std::vector<std::string> &frames, const TranscodedDepth &sbe, const SymbolRegistry &registry)
+    {
+        MarketData::Update update;
+        MarketData::Update sbeUpdate;
+        for (std::size_t i = 0; i < sbe.snapshots.size(); ++i)
+        {
+            const std::string &f = frames[sbe.sources[i]];
+            const std::string &b = sbe.snapshots[i];
+            if (!Depth5Parser::parse(f.data(), f.size(), registry, update) ||
+                !SbeParser::parseDepthSnapshot(b.data(), b.size(), registry, sbeUpdate) || sbeUpdate.symbol != update.symbol ||
+                !sameLevels(sbeUpdate.bids, update.bids) || !sameLevels(sbeUpdate.asks, update.asks))
+            {
+                std::cerr << "sbe depth snapshot mismatch on frame: " << f << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // SBE bestBidAsk against BookTickerParser
+    bool checkSbeTickers(const std::vector<std::string> &tickers, const SymbolRegistry &registry, std::size_t &checked)
+    {
+        std::vector<std::size_t> sources;
+        const std::vector<std::string> sbe = transcodeTickers(tickers, registry, &sources);
+        MarketData::TopOfBook tob;
+        MarketData::TopOfBook sbeTob;
+        for (std::size_t i = 0; i < sbe.size(); ++i)
+        {
+            const std::string &f = tickers[sources[i]];
+            if (!BookTickerParser::parse(f.data(), f.size(), registry, tob) ||
+                !SbeParser::parseBestBidAsk(sbe[i].data(), sbe[i].size(), registry, sbeTob) || sbeTob.symbol != tob.symbol ||
+                sbeTob.updateId != tob.updateId || !sameLevel(sbeTob.bid, tob.bid) || !sameLevel(sbeTob.ask, tob.ask))
+            {
+                std::cerr << "sbe bestBidAsk mismatch on frame: " << f << "\n";
+                return false;
+            }
+        }
+        checked = sbe.size();
+        return checked != 0;
+    }
+
+    // SBE diffs decode to what was written, one-sided ones included
+    bool checkSbeDiffs(const std::vector<std::string> &frames, const std::vector<DepthDiff> &expected, const SymbolRegistry &registry)
+    {
+        DepthDiff diff;
+        for (std::size_t i = 0; i < frames.size(); ++i)
+        {
+            const DepthDiff &e = expected[i];
+            if (!SbeParser::parseDepthDiff(frames[i].data(), frames[i].size(), registry, diff) || diff.symbol != e.symbol ||
+                diff.firstUpdateId != e.firstUpdateId || diff.lastUpdateId != e.lastUpdateId || diff.prevUpdateId != -1 ||
+                !sameLevels(diff.bids, e.bids) || !sameLevels(diff.asks, e.asks))
+            {
+                std::cerr << "sbe depth diff mismatch on diff " << i << " (" << registry.name(e.symbol) << " "
+                          << e.firstUpdateId << "-" << e.lastUpdateId << ")\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the SBE diffs through MarketData's DiffDepth path: snapshot sync, then every diff chained
+    // through checkSequence on firstUpdateId alone (SBE has no pu); the book must match the same
+    // diffs folded by hand after every frame, and a skipped id must force a resync
+    bool checkSbeDiffSequence(const std::vector<std::string> &frames, const std::vector<DepthDiff> &expected,
+                              const SymbolRegistry &registry)
+    {
+        // the first diff of each symbol doubles as its snapshot, taken just before it
+        MemorySnapshots snapshots;
+        std::vector<OrderBook> reference(registry.size());
+        std::vector<bool> seeded(registry.size(), false);
+        for (const auto &e : expected)
+        {
+            if (seeded[e.symbol])
+                continue;
+            seeded[e.symbol] = true;
+            DepthDiff seed = e;
+            seed.lastUpdateId = e.firstUpdateId - 1;
+            snapshots.bodies[registry.name(e.symbol)] = snapshotBody(seed.lastUpdateId, seed.bids, seed.asks);
+            applyDiff(reference[e.symbol], seed);
+        }
+
+        asio::io_context ioc;
+        ssl::context ctx{ssl::context::tlsv12_client};
+        std::vector<SymbolId> symbols;
+        for (SymbolId s = 0; s < registry.size(); ++s)
+            symbols.push_back(s);
+        MarketData md(ioc, ctx, "localhost", "443", registry, symbols);
+        md.setEncoding(MarketData::Encoding::Sbe);
+        md.setFeed(MarketData::Feed::DiffDepth, &snapshots);
+        md.onUpdate([](const MarketData::Update &) {});
+        for (std::size_t i = 0; i < frames.size(); ++i)
+        {
+            const DepthDiff &e = expected[i];
+            md.processFrame(frames[i].data(), frames[i].size());
+            applyDiff(reference[e.symbol], e);
+            if (!sameBook(md.book(e.symbol), reference[e.symbol]))
+            {
+                std::cerr << "sbe diff book mismatch after diff " << i << " (" << registry.name(e.symbol) << " "
+                          << e.firstUpdateId << "-" << e.lastUpdateId << ")\n";
+                return false;
+            }
+            if (md.resyncCount(e.symbol) != 0)
+            {
+                std::cerr << "sbe diff " << i << " was taken for a gap\n";
+                return false;
+            }
+        }
+
+        const DepthDiff &tail = expected.back();
+        std::string gap;
+        SbeWriter::depthDiff(gap, registry.name(tail.symbol), 1700000000123000, tail.lastUpdateId + 2,
+                             tail.lastUpdateId + 2, PriceExponent, QtyExponent, nullptr, 0, nullptr, 0);
+        md.processFrame(gap.data(), gap.size());
+        if (md.resyncCount(tail.symbol) != 1)
+        {
+            std::cerr << "sbe diff skipping update " << tail.lastUpdateId + 1 << " did not resync\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+bool bench::checkDecoders(const Options &options)
+{
+    const std::vector<std::string> frames = depthFrames(options);
+    if (frames.empty())
+    {
+        std::cerr << "no frames to check\n";
+        return false;
+    }
+    SymbolRegistry registry;
+    registry.add("BTCUSDT");
+    registry.add("ETHUSDT");
+
+    const TranscodedDepth sbe = transcodeDepth(frames, registry);
+    std::vector<std::string> diffs;
+    std::vector<DepthDiff> expected;
+    chainDiffs(frames, registry, diffs, expected);
+    if (sbe.snapshots.empty() || diffs.empty())
+    {
+        std::cerr << "no frame fits the 0.01 / 0.001 exponents\n";
+        return false;
+    }
+
+    std::size_t tickers = 0;
+    if (!checkDepth5(frames, registry) || !checkSbeSnapshots(frames, sbe, registry) ||
+        !checkSbeTickers(generateTickerFrames(frames.size()), registry, tickers) || !checkSbeDiffs(diffs, expected, registry) ||
+        !checkSbeDiffSequence(diffs, expected, registry))
+        return false;
+    std::printf("check: %zu depth5 frames match std::stod, %zu sbe snapshots, %zu bestBidAsk and %zu chained diffs match json\n",
+                frames.size(), sbe.snapshots.size(), tickers, diffs.size());
+    return true;
+}
+
+void bench::runDecodeBenchmarks(const Options &options)
+{
+    const bool recorded = !options.framesPath.empty();
+    std::vector<std::string> frames = depthFrames(options);
+    if (frames.empty())
+    {
+        std::cerr << "no frames to decode\n";
+        return;
+    }
+    std::printf("decode: %zu frames, %s\n", frames.size(), recorded ? options.framesPath.c_str() : "generated");
+
+    const int rounds = options.rounds;
+    LegacyUpdate legacy;
+    run(options, "decode/nlohmann+stod", frames, std::max(1, rounds / 10), [&](const std::string &f)
+        {
+        legacyDecode(f, legacy);
+        return legacy.midPrice(); });
+
+    SymbolRegistry registry;
+    registry.add("BTCUSDT");
+    registry.add("ETHUSDT");
+    MarketData::Update update;
+    run(options, "decode/Depth5Parser", frames, rounds, [&](const std::string &f)
+        {
+        if (!Depth5Parser::parse(f.data(), f.size(), registry, update))
+            std::abort();
+        return update.midPrice(); });
+
+    std::vector<std::string> tickers = generateTickerFrames(frames.size());
+    MarketData::TopOfBook tob;
+    run(options, "decode/BookTickerParser", tickers, rounds, [&](const std::string &f)
+        {
+        if (!BookTickerParser::parse(f.data(), f.size(), registry, tob))
+            std::abort();
+        return tob.midPrice(); });
+
+    // generated depth5 frames carry U/u/pu, so they double as diff events
+    DepthDiff diff;
+    run(options, "decode/DepthDiffParser", frames, rounds, [&](const std::string &f)
+        {
+        if (!DepthDiffParser::parse(f.data(), f.size(), registry, diff))
+            std::abort();
+        return diff.bids.front().price.toDouble(); });
+
+    // binary SBE against the json parsers above, same books; recorded frames that do not fit the
+    // 0.01 / 0.001 exponents are left out
+    const TranscodedDepth sbe = transcodeDepth(frames, registry);
+    const std::vector<std::string> sbeTickers = transcodeTickers(tickers, registry);
+    run(options, "decode/SbeParser depthSnapshot", sbe.snapshots, rounds, [&](const std::string &f)
+        {
+        if (!SbeParser::parseDepthSnapshot(f.data(), f.size(), registry, update))
+            std::abort();
+        return update.midPrice(); });
+    run(options, "decode/SbeParser depthDiff", sbe.diffs, rounds, [&](const std::string &f)
+        {
+        if (!SbeParser::parseDepthDiff(f.data(), f.size(), registry, diff))
+            std::abort();
+        return diff.bids.front().price.toDouble(); });
+    run(options, "decode/SbeParser bestBidAsk", sbeTickers, rounds, [&](const std::string &f)
+        {
+        if (!SbeParser::parseBestBidAsk(f.data(), f.size(), registry, tob))
+            std::abort();
+        return tob.midPrice(); });
+
+    // parse plus delivery into a callback, what the read handler does per frame
+    asio::io_context ioc;
+    ssl::context ctx{ssl::context::tlsv12_client};
+    MarketData md(ioc, ctx, "localhost", "443", registry, {0, 1});
+    double mid = 0.0;
+    md.onUpdate([&mid](const MarketData::Update &u)
+                { mid = u.midPrice(); });
+    md.onTopOfBook([&mid](const MarketData::TopOfBook &t)
+                   { mid = t.midPrice(); });
+    md.setFeed(MarketData::Feed::Depth5);
+    run(options, "decode/MarketData depth5", frames, rounds, [&](const std::string &f)
+        {
+        md.processFrame(f.data(), f.size());
+        return mid; });
+    md.setFeed(MarketData::Feed::BookTicker);
+    run(options, "decode/MarketData bookTicker", tickers, rounds, [&](const std::string &f)
+        {
+        md.processFrame(f.data(), f.size());
+        return mid; });
+    md.setEncoding(MarketData::Encoding::Sbe);
+    md.setFeed(MarketData::Feed::Depth5);
+    run(options, "decode/MarketData sbe depth", sbe.snapshots, rounds, [&](const std::string &f)
+        {
+        md.processFrame(f.data(), f.size());
+        return mid; });
+    md.setFeed(MarketData::Feed::BookTicker);
+    run(options, "decode/MarketData sbe bestBidAsk", sbeTickers, rounds, [&](const std::string &f)
+        {
+        md.processFrame(f.data(), f.size());
+        return mid; });
+}
@@ -0,0 +1,88 @@
+#include <BenchHarness.hpp>
+#include <OrderEncoder.hpp>
+#include <OrderManager.hpp>
+#include <RiskManager.hpp>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+
+// order side: risk approval, order encoding and serialization, and the ack lookup by client id
+
+namespace
+{
+    std::vector<OrderRequest> generateRequests(std::size_t count)
+    {
+        std::mt19937_64 rng(23);
+        std::uniform_int_distribution<int> coin(0, 1);
+        std::uniform_real_distribution<double> qty(0.01, 2.0);
+        std::uniform_real_distribution<double> drift(-5.0, 5.0);
+        const double mids[] = {43250.10, 2290.35};
+
+        std::vector<OrderRequest> requests(count);
+        for (auto &r : requests)
+        {
+            const int s = coin(rng);
+            r.symbol = static_cast<SymbolId>(s);
+            r.side = coin(rng) ? OrderSide::BUY : OrderSide::SELL;
+            r.quantity = Fixed::fromDouble(qty(rng));
+            r.price = Fixed::fromDouble(mids[s] + drift(rng));
+        }
+        return requests;
+    }
+}
+
+void bench::runOrderBenchmarks(const Options &options)
+{
+    const std::vector<OrderRequest> requests = generateRequests(10000);
+
+    SymbolRegistry registry;
+    registry.add("BTCUSDT");
+    registry.add("ETHUSDT");
+    registry.setFilters(0, Fixed::fromUnits(1000000), Fixed::fromUnits(1000));
+    registry.setFilters(1, Fixed::fromUnits(1000000), Fixed::fromUnits(10000));
+    asio::io_context ioc;
+    ssl::context ctx{ssl::context::tlsv12_client};
+    OrderManager om(ioc, ctx, "localhost", "443", registry);
+    RiskManager rm(om, registry, Fixed::fromDouble(5.0), Fixed::fromDouble(500000.0));
+
+    std::string reason;
+    run(options, "risk/RiskManager approve", requests, options.rounds, [&](const OrderRequest &r)
+        { return rm.approve(r.symbol, r.side, r.quantity, r.price, reason) ? 1.0 : 0.0; });
+
+    OrderEncoder encoder(registry);
+    std::array<char, OrderEncoder::MaxMessageSize> message;
+    run(options, "orders/OrderEncoder encodePlace", requests, options.rounds, [&](const OrderRequest &r)
+        { return static_cast<double>(encoder.encodePlace(message.data(), message.size(), "client_1234567", r.symbol,
+                                                         r.side, r.quantity, r.price)); });
+    run(options, "orders/OrderEncoder encodeCancel", requests, options.rounds, [&](const OrderRequest &r)
+        { return static_cast<double>(encoder.encodeCancel(message.data(), message.size(), "client_1234567", r.symbol)); });
+    run(options, "orders/OrderEncoder encodeCancelReplace", requests, options.rounds, [&](const OrderRequest &r)
+        { return static_cast<double>(encoder.encodeCancelReplace(message.data(), message.size(), "client_1234568", "client_1234567",
+                                                                 r.symbol, r.side, r.quantity, r.price)); });
+
+    // id allocation, order map insert and the post to the socket strand, encoding happens there
+    std::vector<OrderId> ids;
+    ids.reserve(requests.size() * (options.rounds + 1));
+    run(options, "orders/OrderManager sendOrder", requests, options.rounds, [&](const OrderRequest &r)
+        {
+        ids.push_back(om.sendOrder(r.side, r.quantity, r.price, r.symbol));
+        return r.price.toDouble(); });
+
+    // the strand handlers stay queued: nothing is connected, so running them would reject and
+    // release every order before the acks below could find it
+    if (ids.empty())
+    {
+        for (const auto &r : requests)
+            ids.push_back(om.sendOrder(r.side, r.quantity, r.price, r.symbol));
+    }
+
+    // acks arrive in a different order than the sends went out
+    std::vector<OrderId> ackOrder(ids.begin(), ids.begin() + std::min<std::size_t>(ids.size(), 100000));
+    std::shuffle(ackOrder.begin(), ackOrder.end(), std::mt19937_64(5));
+    run(options, "orders/handleExchangeAcknowledge", ackOrder, options.rounds, [&](OrderId id)
+        {
+        om.handleExchangeAcknowledge(id, Fixed(), Fixed(), true);
+        return 1.0; });
+}
@@ -0,0 +1,115 @@
+#include <BenchHarness.hpp>
+#include <OrderStore.hpp>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// order bookkeeping over a long session: the string-keyed map OrderManager used to keep
+// (nothing ever erased) against OrderStore with slot recycling
+//  - every order is inserted, looked up once for its ack and once for its fill
+//  - a fixed number of orders stay open, acks and fills come back in a shuffled order
+
+namespace
+{
+    constexpr std::size_t SessionOrders = 5000000;
+    constexpr std::size_t OpenOrders = 1024;
+
+    // order in which the open window gets acked / filled, reused every window
+    std::vector<std::size_t> ackPermutation()
+    {
+        std::vector<std::size_t> order(OpenOrders);
+        for (std::size_t i = 0; i < OpenOrders; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), std::mt19937_64(17));
+        return order;
+    }
+
+    Order sampleOrder(std::size_t n)
+    {
+        Order order;
+        order.symbol = static_cast<SymbolId>(n & 1);
+        order.side = (n & 2) ? OrderSide::BUY : OrderSide::SELL;
+        order.quantity = Fixed::fromUnits(1000000 * static_cast<int64_t>(1 + n % 100));
+        order.price = Fixed::fromUnits(4325000000000 + 1000000 * static_cast<int64_t>(n % 1000));
+        order.status = OrderStatus::NEW;
+        return order;
+    }
+
+    void printMemory(const char *name, uint64_t bytes)
+    {
+        std::printf("%-34s %10.1f MB after %zu orders\n", name, static_cast<double>(bytes) / (1024.0 * 1024.0), SessionOrders);
+    }
+}
+
+void bench::runOrderStoreBenchmarks(const Options &options)
+{
+    const std::vector<std::size_t> acks = ackPermutation();
+
+    if (selected(options, "orderstore/legacy string map"))
+    {
+        std::unordered_map<std::string, Order> orders;
+        std::vector<std::string> window(OpenOrders);
+        double checksum = 0.0;
+        const uint64_t allocBefore = allocations();
+        const uint64_t bytesBefore = allocatedBytes();
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t n = 0; n < SessionOrders; n += OpenOrders)
+        {
+            for (std::size_t i = 0; i < OpenOrders; ++i)
+            {
+                window[i] = "client_" + std::to_string(n + i + 1);
+                orders.emplace(window[i], sampleOrder(n + i));
+            }
+            // ack then fill, both resolve the id the exchange echoes back
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (std::size_t i : acks)
+                {
+                    auto it = orders.find(window[i]);
+                    it->second.status = pass == 0 ? OrderStatus::ACKED : OrderStatus::FILLED;
+                    checksum += it->second.price.toDouble();
+                }
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        report("orderstore/legacy string map", static_cast<double>(SessionOrders),
+               std::chrono::duration<double, std::nano>(elapsed).count(), allocations() - allocBefore, checksum);
+        printMemory("orderstore/legacy string map", allocatedBytes() - bytesBefore);
+    }
+
+    if (selected(options, "orderstore/OrderStore"))
+    {
+        const uint64_t bytesBefore = allocatedBytes();
+        OrderStore orders;
+        std::vector<OrderId> window(OpenOrders);
+        char wire[OrderStore::MaxWireIdSize];
+        double checksum = 0.0;
+        const uint64_t allocBefore = allocations();
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t n = 0; n < SessionOrders; n += OpenOrders)
+        {
+            for (std::size_t i = 0; i < OpenOrders; ++i)
+                window[i] = orders.insert(sampleOrder(n + i));
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (std::size_t i : acks)
+                {
+                    // the exchange echoes the wire form, so the parse is part of the lookup
+                    const std::size_t size = OrderStore::formatId(wire, window[i]);
+                    Order *order = orders.find(OrderStore::parseId(std::string_view(wire, size)));
+                    order->status = pass == 0 ? OrderStatus::ACKED : OrderStatus::FILLED;
+                    checksum += order->price.toDouble();
+                    if (pass == 1)
+                        orders.release(order->id);
+                }
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        report("orderstore/OrderStore", static_cast<double>(SessionOrders),
+               std::chrono::duration<double, std::nano>(elapsed).count(), allocations() - allocBefore, checksum);
+        printMemory("orderstore/OrderStore", allocatedBytes() - bytesBefore);
+    }
+}
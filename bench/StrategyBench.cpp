@@ -0,0 +1,66 @@
+#include <BenchHarness.hpp>
+#include <PairsMeanReversionStrategy.hpp>
+#include <RollingStats.hpp>
+#include <random>
+#include <vector>
+
+// signal side: RollingStats window maintenance and the pairs strategy per market data update
+
+namespace
+{
+    // btc/eth-like mids on a correlated random walk, alternating symbols like the live stream
+    std::vector<MarketData::Update> generateUpdates(std::size_t count)
+    {
+        std::mt19937_64 rng(11);
+        std::normal_distribution<double> common(0.0, 1.0);
+        std::normal_distribution<double> noise(0.0, 0.3);
+        double mids[] = {43250.10, 2290.35};
+        const double ticks[] = {0.10, 0.01};
+
+        std::vector<MarketData::Update> updates(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const int s = static_cast<int>(i & 1);
+            const double shock = common(rng);
+            mids[s] += (shock + noise(rng)) * ticks[s] * 20;
+            MarketData::Update &u = updates[i];
+            u.symbol = static_cast<SymbolId>(s);
+            for (int l = 0; l < 5; ++l)
+            {
+                u.bids.push_back({Fixed::fromDouble(mids[s] - (l + 1) * ticks[s]), Fixed::fromDouble(1.0 + l)});
+                u.asks.push_back({Fixed::fromDouble(mids[s] + (l + 1) * ticks[s]), Fixed::fromDouble(1.0 + l)});
+            }
+        }
+        return updates;
+    }
+}
+
+void bench::runStrategyBenchmarks(const Options &options)
+{
+    const std::vector<MarketData::Update> updates = generateUpdates(10000);
+
+    std::vector<double> spreads;
+    spreads.reserve(updates.size());
+    for (const auto &u : updates)
+        spreads.push_back(u.midPrice());
+
+    RollingStats stats(20);
+    run(options, "stats/RollingStats add+mean+stddev", spreads, options.rounds, [&](double x)
+        {
+        stats.add(x);
+        return stats.ready() ? stats.mean() + stats.stddev() : 0.0; });
+
+    // the strategy reaches into risk and orders on a signal, same wiring as main minus the socket
+    SymbolRegistry registry;
+    registry.add("BTCUSDT");
+    registry.add("ETHUSDT");
+    asio::io_context ioc;
+    ssl::context ctx{ssl::context::tlsv12_client};
+    OrderManager om(ioc, ctx, "localhost", "443", registry);
+    RiskManager rm(om, registry, Fixed::fromDouble(5.0), Fixed::fromDouble(500000.0));
+    PairsMeanReversionStrategy strategy(om, rm, 0, 1, 0.065, 20, 2.0, 0.5);
+    run(options, "strategy/Pairs onMarketData", updates, options.rounds, [&](const MarketData::Update &u)
+        {
+        strategy.onMarketData(u);
+        return u.midPrice(); });
+}
@@ -0,0 +1,128 @@
+#include <BenchHarness.hpp>
+#include <ExecutionContext.hpp>
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/websocket.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// loopback websocket round trips through the reactor: a client frame out, the echo back in
+//  - plain tcp, TLS would bury the reactor cost under the cipher
+//  - both ends on one io_context driven from this thread, every frame is one reactor pass per side
+//  - build once with and once without -DHFT_IO_URING=ON to compare io_uring against epoll
+
+namespace
+{
+    namespace asio = boost::asio;
+    namespace beast = boost::beast;
+    namespace ws = beast::websocket;
+    using tcp = asio::ip::tcp;
+    using Socket = ws::stream<tcp::socket>;
+
+    // reads a frame, writes it back, forever
+    struct Echo
+    {
+        Socket &socket;
+        beast::flat_buffer buffer;
+
+        void read()
+        {
+            socket.async_read(buffer, [this](beast::error_code ec, std::size_t)
+                              {
+                if (ec)
+                    return;
+                socket.text(socket.got_text());
+                socket.async_write(buffer.data(), [this](beast::error_code ec, std::size_t)
+                                   {
+                    if (ec)
+                        return;
+                    buffer.consume(buffer.size());
+                    read(); }); });
+        }
+    };
+
+    // a depth5-sized payload, the common frame on the feed
+    std::vector<std::string> generateFrames(std::size_t count)
+    {
+        std::vector<std::string> frames;
+        frames.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::string frame = "{\"stream\":\"btcusdt@depth5@100ms\",\"data\":{\"lastUpdateId\":" + std::to_string(160000000 + i) +
+                                ",\"bids\":[[\"43250.10\",\"0.512\"],[\"43250.00\",\"1.250\"],[\"43249.90\",\"0.004\"]," +
+                                "[\"43249.80\",\"2.000\"],[\"43249.70\",\"0.300\"]],\"asks\":[[\"43250.20\",\"0.100\"]," +
+                                "[\"43250.30\",\"0.750\"],[\"43250.40\",\"1.111\"],[\"43250.50\",\"0.020\"],[\"43250.60\",\"3.000\"]]}}";
+            frames.push_back(std::move(frame));
+        }
+        return frames;
+    }
+}
+
+void bench::runTransportBenchmarks(const Options &options)
+{
+    const std::string name = std::string("transport/") + ExecutionContext::backend() + " ws echo round trip";
+    if (!selected(options, name.c_str()))
+        return;
+
+    asio::io_context ioc{1};
+    // between the handshake steps nothing may be outstanding, which would stop the context
+    auto work = asio::make_work_guard(ioc);
+    tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    Socket server(ioc);
+    Socket client(ioc);
+
+    bool accepted = false;
+    bool connected = false;
+    acceptor.async_accept(server.next_layer(), [&](beast::error_code ec)
+                          {
+        if (ec)
+            return;
+        server.next_layer().set_option(tcp::no_delay(true));
+        server.async_accept([&](beast::error_code ec)
+                            { accepted = !ec; }); });
+    client.next_layer().async_connect(acceptor.local_endpoint(), [&](beast::error_code ec)
+                                      {
+        if (ec)
+            return;
+        client.next_layer().set_option(tcp::no_delay(true));
+        client.async_handshake("127.0.0.1", "/", [&](beast::error_code ec)
+                               { connected = !ec; }); });
+    for (int i = 0; i < 64 && (!accepted || !connected); ++i)
+        ioc.run_one_for(std::chrono::milliseconds(100));
+    if (!accepted || !connected)
+    {
+        std::cerr << name << ": loopback handshake failed\n";
+        return;
+    }
+
+    Echo echo{server, {}};
+    echo.read();
+    client.text(true);
+
+    const std::vector<std::string> frames = generateFrames(1000);
+    beast::flat_buffer reply;
+    reply.reserve(4096);
+    // fewer rounds than the cpu-only suites, each op is four syscalls or ring entries
+    run(options, name.c_str(), frames, std::max(1, options.rounds / 10), [&](const std::string &frame)
+        {
+        bool done = false;
+        client.async_write(asio::buffer(frame), [&](beast::error_code ec, std::size_t)
+                           {
+            if (ec)
+            {
+                done = true;
+                return;
+            }
+            client.async_read(reply, [&](beast::error_code, std::size_t)
+                              { done = true; }); });
+        while (!done)
+            ioc.run_one();
+        const double size = static_cast<double>(reply.size());
+        reply.consume(reply.size());
+        return size; });
+
+    beast::error_code ec;
+    client.next_layer().close(ec);
+    server.next_layer().close(ec);
+}
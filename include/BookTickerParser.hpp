@@ -0,0 +1,15 @@
+#pragma once
+
+#include <MarketData.hpp>
+#include <SymbolRegistry.hpp>
+#include <cstddef>
+
+// parser for binance <sym>@bookTicker payloads
+//  {"u":400900217,"s":"BNBUSDT","b":"25.35","B":"31.21","a":"25.36","A":"40.66"}
+//  - only four decimals and an id per message, nothing to skip past beyond the envelope
+class BookTickerParser
+{
+public:
+    // returns false on malformed payloads or unknown symbols
+    static bool parse(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::TopOfBook &out);
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <SymbolRegistry.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// latest-value handoff keyed by symbol, single producer and single consumer
+//  - one seqlocked slot per symbol, publish overwrites whatever the consumer has not read yet
+//  - a dirty bitmap tells the consumer which symbols changed since it last looked
+//  - the consumer counts the versions it never saw per symbol, that is the conflation count
+template <typename Event>
+class ConflationSlots
+{
+    static_assert(std::is_trivially_copyable<Event>::value, "ConflationSlots copies events with memcpy");
+
+public:
+    explicit ConflationSlots(std::size_t symbols)
+        : slots(symbols), words((symbols + 63) / 64),
+          dirty(new std::atomic<uint64_t>[words]), skipped(new std::atomic<uint64_t>[symbols]),
+          lastSeq(symbols, 0)
+    {
+        for (std::size_t i = 0; i < words; ++i)
+            dirty[i].store(0, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < symbols; ++i)
+            skipped[i].store(0, std::memory_order_relaxed);
+    }
+
+    // producer thread only, false for a symbol outside the registry
+    bool publish(SymbolId symbol, const Event &event)
+    {
+        const std::size_t id = symbol;
+        if (id >= slots.size())
+            return false;
+
+        Slot &slot = slots[id];
+        const uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.value, &event, sizeof(Event));
+        slot.seq.store(seq + 2, std::memory_order_release);
+
+        dirty[id / 64].fetch_or(uint64_t{1} << (id % 64), std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread only, hands the latest value of every dirty symbol to fn
+    template <typename Fn>
+    std::size_t drain(Fn &&fn)
+    {
+        std::size_t delivered = 0;
+        Event event;
+        for (std::size_t w = 0; w < words; ++w)
+        {
+            uint64_t bits = dirty[w].exchange(0, std::memory_order_acquire);
+            while (bits != 0)
+            {
+                const std::size_t id = w * 64 + static_cast<std::size_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+
+                const uint64_t seq = read(slots[id], event);
+                // a publish racing the exchange above re-marks the slot we just read
+                if (seq == lastSeq[id])
+                    continue;
+                const uint64_t missed = (seq - lastSeq[id]) / 2 - 1;
+                if (missed != 0)
+                    skipped[id].fetch_add(missed, std::memory_order_relaxed);
+                lastSeq[id] = seq;
+
+                fn(event);
+                ++delivered;
+            }
+        }
+        return delivered;
+    }
+
+    // symbols with an undelivered update, approximate from any thread
+    std::size_t pending() const
+    {
+        std::size_t n = 0;
+        for (std::size_t w = 0; w < words; ++w)
+            n += static_cast<std::size_t>(__builtin_popcountll(dirty[w].load(std::memory_order_relaxed)));
+        return n;
+    }
+
+    // updates overwritten before the consumer saw them
+    uint64_t conflated(SymbolId symbol) const
+    {
+        return symbol < slots.size() ? skipped[symbol].load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t conflatedTotal() const
+    {
+        uint64_t total = 0;
+        for (std::size_t i = 0; i < slots.size(); ++i)
+            total += skipped[i].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    std::size_t size() const { return slots.size(); }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> seq{0};
+        Event value;
+    };
+
+    static uint64_t read(const Slot &slot, Event &out)
+    {
+        while (true)
+        {
+            const uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1)
+                continue;
+            std::memcpy(&out, &slot.value, sizeof(Event));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before)
+                return before;
+        }
+    }
+
+    std::vector<Slot> slots;
+    std::size_t words;
+    std::unique_ptr<std::atomic<uint64_t>[]> dirty;
+    std::unique_ptr<std::atomic<uint64_t>[]> skipped;
+    // consumer only
+    std::vector<uint64_t> lastSeq;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <MarketData.hpp>
+#include <SymbolRegistry.hpp>
+#include <cstddef>
+
+// streaming parser for binance <sym>@depth5 payloads
+//  - reads straight from the receive buffer, no DOM, no std::stod
+//  - accepts the combined-stream envelope {"stream":...,"data":{...}} or a bare data object
+//  - writes into the fixed-capacity Update, so it never allocates
+class Depth5Parser
+{
+public:
+    // returns false on malformed payloads, unknown symbols or an empty side, `out` is then unspecified
+    static bool parse(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::Update &out);
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <OrderBook.hpp>
+#include <SymbolRegistry.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// one <sym>@depth diff event, or a /depth REST snapshot
+struct DepthDiff
+{
+    SymbolId symbol = InvalidSymbol;
+    int64_t firstUpdateId = 0; // U
+    int64_t lastUpdateId = 0;  // u, or lastUpdateId on a snapshot
+    int64_t prevUpdateId = -1; // pu, futures streams only
+    std::vector<PriceLevel> bids;
+    std::vector<PriceLevel> asks;
+};
+
+// parses diff-depth events and depth snapshots in place
+//  - keeps the level vectors' capacity, so a reused DepthDiff stops allocating once warm
+class DepthDiffParser
+{
+public:
+    // diff event, combined-stream envelope or bare
+    static bool parse(const char *data, std::size_t size, const SymbolRegistry &registry, DepthDiff &out);
+    // {"lastUpdateId":...,"bids":[...],"asks":[...]}, the symbol is known by the caller
+    static bool parseSnapshot(const char *data, std::size_t size, DepthDiff &out);
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Fixed.hpp>
+#include <ThreadUtil.hpp>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// runtime settings for the engine, defaults are the live binance setup
+//  - loaded from a json file passed on the command line, missing keys keep their default
+class EngineConfig
+{
+public:
+    struct Endpoint
+    {
+        std::string host;
+        std::string port;
+    };
+
+    // throws std::runtime_error on unreadable files or wrongly typed keys
+    static EngineConfig load(const std::string &path);
+
+    Endpoint marketData{"fstream.binance.com", "443"};
+    Endpoint orders{"testnet.binance.vision", "443"};
+    std::vector<std::string> symbols{"BTCUSDT", "ETHUSDT"};
+
+    // exchange tick / lot steps per symbol, symbols left out keep SymbolInfo's defaults;
+    // numbers or exchangeInfo-style strings such as "0.01000000"
+    struct Filters
+    {
+        Fixed tickSize;
+        Fixed lotSize;
+    };
+    std::map<std::string, Filters> filters;
+
+    // "auto" lets the strategy pick, otherwise depth5 | diff | bookTicker
+    std::string feed = "auto";
+    // "json", or "sbe" for the binary streams; point marketData at stream-sbe.binance.com
+    std::string encoding = "json";
+    // X-MBX-APIKEY for the SBE streams
+    std::string apiKey;
+    // diff feed: snapshots from <dir>/<SYMBOL>.json, or REST when empty
+    std::string snapshotDir;
+    Endpoint snapshotRest{"fapi.binance.com", "443"};
+    std::string snapshotPath = "/fapi/v1/depth";
+
+    // extra trust anchor, e.g. the local simulator's self-signed certificate
+    std::string caFile;
+    bool verifyPeer = true;
+
+    // both websocket sessions, see WsConnection::Settings
+    struct Connection
+    {
+        bool noDelay = true;
+        // SO_RCVBUF / SO_SNDBUF bytes, 0 keeps the kernel default
+        int receiveBuffer = 0;
+        int sendBuffer = 0;
+        // SO_BUSY_POLL microseconds, 0 leaves it off
+        int busyPollMicros = 0;
+        // reconnect backoff, doubles from min to max
+        int reconnectMinMs = 50;
+        int reconnectMaxMs = 5000;
+        // receive buffer reserved per session, bytes
+        std::size_t frameBuffer = 64 * 1024;
+    };
+    Connection connection;
+
+    // strategy on its own thread, fed from the io thread through an spsc ring
+    struct Pipeline
+    {
+        bool enabled = false;
+        // cpu for the strategy thread, -1 leaves it unpinned
+        int core = -1;
+        std::size_t capacity = 4096;
+        // latest update per symbol only, a lagging strategy never works through a backlog
+        bool conflate = false;
+    };
+    Pipeline pipeline;
+
+    // where each stage runs
+    struct ThreadPlacement
+    {
+        // -1 leaves the thread unpinned
+        int core = -1;
+        // "normal", "fifo" or "rr" in the file
+        ThreadUtil::Scheduling scheduling = ThreadUtil::Scheduling::Normal;
+        int priority = 0;
+        // "spin": true busy polls the context instead of blocking, with "idle" ("pause", "yield",
+        // "sleep"), "idleSpins" and "sleepMicros"; the pipeline thread always spins
+        ThreadUtil::SpinPolicy spin;
+    };
+    struct Threads
+    {
+        // market data and order entry on one thread, the strategy inline on it ("mode": "single");
+        // otherwise each gets its own ("mode": "dedicated")
+        bool single = false;
+        // the single thread in single mode
+        ThreadPlacement marketData;
+        ThreadPlacement orders;
+        // the pipeline thread, its core falls back to pipeline.core
+        ThreadPlacement strategy;
+    };
+    Threads threads;
+
+    // record received frames here when set
+    std::string journal;
+    struct LogSettings
+    {
+        // binary log for log_decode, none when empty
+        std::string file;
+        // formatted lines on stdout / stderr
+        bool console = true;
+    };
+    LogSettings log;
+    // stop after this many seconds, 0 runs until killed
+    int runSeconds = 0;
+};
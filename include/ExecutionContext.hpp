@@ -0,0 +1,81 @@
+#pragma once
+
+#include <ThreadUtil.hpp>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+
+// one io_context and the one thread that runs it, the unit components are placed on
+//  - MarketData and OrderManager take context() and never own a thread; main decides the
+//    topology: a context each, or both on one context for single-threaded mode
+//  - the thread places itself (core, scheduling policy) before it runs its first handler
+//  - with spin set the thread never sleeps in epoll_wait: it polls the context in a loop and
+//    backs off per the idle policy, trading a core for the wakeup on every frame; pair it with
+//    connection.busyPollMicros so the socket reads busy poll the device queue too
+//  - the reactor underneath is fixed at build time: epoll, or io_uring with -DHFT_IO_URING=ON
+//  - start() and stop() may repeat; stop() drops whatever is still queued, so components close
+//    their sessions before their context stops
+class ExecutionContext
+{
+public:
+    struct Options
+    {
+        // shows up in logs and as the thread name
+        std::string name;
+        // cpu for the thread, -1 leaves it unpinned
+        int core = -1;
+        ThreadUtil::Scheduling scheduling = ThreadUtil::Scheduling::Normal;
+        // 1-99 for the realtime policies, ignored for Normal
+        int priority = 0;
+        ThreadUtil::SpinPolicy spin;
+    };
+
+    // spin mode only, published by the context thread, readable from any thread
+    struct Stats
+    {
+        // ioc.poll() calls
+        uint64_t polls;
+        // polls that ran no handler
+        uint64_t idlePolls;
+        // handlers run, the useful work
+        uint64_t handlers;
+        // yields / sleeps taken by the idle policy
+        uint64_t backoffs;
+    };
+
+    explicit ExecutionContext(Options options);
+    ~ExecutionContext();
+
+    ExecutionContext(const ExecutionContext &) = delete;
+    ExecutionContext &operator=(const ExecutionContext &) = delete;
+
+    boost::asio::io_context &context() { return ioc; }
+    const Options &settings() const { return options; }
+
+    void start();
+    void stop();
+    bool running() const { return active.load(std::memory_order_relaxed); }
+    Stats stats() const;
+    // "io_uring" or "epoll", whichever asio was built to run sockets on
+    static const char *backend();
+
+private:
+    void spin();
+
+    Options options;
+    // hint 1: only one thread runs handlers, so the scheduler skips waking other threads and keeps
+    // completions in that thread's private queue; its lock stays, posts from other threads are safe
+    boost::asio::io_context ioc{1};
+    // keeps run() from returning while the components are between sessions
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work;
+    std::thread thread;
+    std::atomic<bool> active{false};
+
+    std::atomic<uint64_t> polls{0};
+    std::atomic<uint64_t> idlePolls{0};
+    std::atomic<uint64_t> handlers{0};
+    std::atomic<uint64_t> backoffs{0};
+};
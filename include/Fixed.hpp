@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// exact decimal held as a count of 1e-8 units, the finest step binance quotes prices and quantities in
+//  - equality and ordering are integer compares, running sums never drift
+//  - per-symbol tick and lot sizes are whole unit counts on the same scale, see SymbolInfo
+//  - products widen through __int128, see notional()
+//  - doubles only appear at the edges: config values and strategy statistics
+struct Fixed
+{
+    static constexpr unsigned Decimals = 8;
+    static constexpr int64_t Scale = 100000000;
+
+    int64_t units = 0;
+
+    static constexpr Fixed fromUnits(int64_t units) { return Fixed{units}; }
+    // nearest unit
+    static Fixed fromDouble(double value) { return Fixed{std::llround(value * static_cast<double>(Scale))}; }
+    double toDouble() const { return static_cast<double>(units) / static_cast<double>(Scale); }
+
+    constexpr bool isZero() const { return units == 0; }
+
+    // plain decimal text as binance sends it, e.g. "43250.10000000"; false on anything else,
+    // including exponents and a nonzero digit past the 8th decimal
+    static bool parse(const char *first, const char *last, Fixed &out)
+    {
+        // largest whole part that still leaves room for the fraction
+        constexpr uint64_t MaxWhole = static_cast<uint64_t>(INT64_MAX / Scale) - 1;
+        constexpr uint64_t Pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+        const char *p = first;
+        const bool negative = p < last && *p == '-';
+        if (negative)
+            ++p;
+        uint64_t whole = 0;
+        bool any = false;
+        for (; p < last && static_cast<unsigned>(*p - '0') < 10; ++p)
+        {
+            whole = whole * 10 + static_cast<unsigned>(*p - '0');
+            if (whole > MaxWhole)
+                return false;
+            any = true;
+        }
+        uint64_t fraction = 0;
+        unsigned places = 0;
+        if (p < last && *p == '.')
+        {
+            for (++p; p < last && static_cast<unsigned>(*p - '0') < 10; ++p)
+            {
+                any = true;
+                if (places < Decimals)
+                {
+                    fraction = fraction * 10 + static_cast<unsigned>(*p - '0');
+                    ++places;
+                }
+                else if (*p != '0')
+                {
+                    return false;
+                }
+            }
+        }
+        if (!any || p != last)
+            return false;
+        const auto magnitude = static_cast<int64_t>(whole * Scale + fraction * Pow10[Decimals - places]);
+        out.units = negative ? -magnitude : magnitude;
+        return true;
+    }
+
+    // decimal text with exactly `decimals` places (at most 8), finer digits are cut off;
+    // out needs room for 24 bytes, returns the bytes written
+    std::size_t format(char *out, unsigned decimals = Decimals) const;
+
+    constexpr Fixed operator-() const { return Fixed{-units}; }
+    constexpr Fixed operator+(Fixed other) const { return Fixed{units + other.units}; }
+    constexpr Fixed operator-(Fixed other) const { return Fixed{units - other.units}; }
+    Fixed &operator+=(Fixed other)
+    {
+        units += other.units;
+        return *this;
+    }
+    Fixed &operator-=(Fixed other)
+    {
+        units -= other.units;
+        return *this;
+    }
+
+    constexpr bool operator==(Fixed other) const { return units == other.units; }
+    constexpr bool operator!=(Fixed other) const { return units != other.units; }
+    constexpr bool operator<(Fixed other) const { return units < other.units; }
+    constexpr bool operator>(Fixed other) const { return units > other.units; }
+    constexpr bool operator<=(Fixed other) const { return units <= other.units; }
+    constexpr bool operator>=(Fixed other) const { return units >= other.units; }
+};
+
+constexpr Fixed abs(Fixed value)
+{
+    return value.units < 0 ? -value : value;
+}
+
+// price * quantity on the same 1e-8 scale, cut toward zero
+inline Fixed notional(Fixed price, Fixed quantity)
+{
+    return Fixed{static_cast<int64_t>(static_cast<__int128>(price.units) * quantity.units / Fixed::Scale)};
+}
+
+// shortest exact text, trailing zeros trimmed
+std::ostream &operator<<(std::ostream &os, Fixed value);
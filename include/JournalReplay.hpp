@@ -0,0 +1,61 @@
+#pragma once
+
+#include <MarketData.hpp>
+#include <MarketDataJournal.hpp>
+#include <SnapshotSource.hpp>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// mmaps a MarketDataJournal file and pushes it back through MarketData
+//  - raw frames go through MarketData::processFrame, decoded records straight to the callbacks
+//  - doubles as the SnapshotSource for DiffDepth journals: each fetch serves the next
+//    recorded snapshot for that symbol, so books resync exactly as they did live
+class JournalReplay : public SnapshotSource
+{
+public:
+    enum class Pacing
+    {
+        // sleep between records to reproduce the recorded inter-arrival times
+        Recorded,
+        AsFastAsPossible
+    };
+
+    // throws std::runtime_error if the file is missing or not a journal
+    explicit JournalReplay(const std::string &path);
+    ~JournalReplay() override;
+
+    JournalReplay(const JournalReplay &) = delete;
+    JournalReplay &operator=(const JournalReplay &) = delete;
+
+    // recorded symbol names, index is the recorded SymbolId
+    const std::vector<std::string> &symbols() const { return symbolNames; }
+    // feed of the first frame, what MarketData should be set to before run()
+    MarketData::Feed feed() const { return recordedFeed; }
+    MarketData::Encoding encoding() const { return recordedEncoding; }
+
+    // views of every raw frame in file order, valid for the lifetime of the replay
+    std::vector<std::string_view> frames() const;
+
+    // replays from the start, returns records delivered; speed scales Recorded pacing
+    std::size_t run(MarketData &md, Pacing pacing, double speed = 1.0);
+    // safe from another thread, run() returns after the current record
+    void stop() { stopping = true; }
+
+    bool fetch(const std::string &symbol, std::string &body) override;
+
+private:
+    // false once past the end or on a truncated tail
+    bool recordAt(std::size_t offset, MarketDataJournal::RecordHeader &header) const;
+
+    int fd = -1;
+    const char *base = nullptr;
+    std::size_t size = 0;
+    std::size_t cursor = 0;
+    std::vector<std::string> symbolNames;
+    MarketData::Feed recordedFeed = MarketData::Feed::Depth5;
+    MarketData::Encoding recordedEncoding = MarketData::Encoding::Json;
+    std::atomic<bool> stopping{false};
+};
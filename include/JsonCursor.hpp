@@ -0,0 +1,154 @@
+#pragma once
+
+#include <Fixed.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// minimal forward-only json scanner over a contiguous buffer
+//  - never allocates, strings come back as views into the buffer
+//  - no escape decoding, binance keys/values never contain escapes
+//  - every method returns false on malformed input
+class JsonCursor
+{
+public:
+    JsonCursor(const char *begin, const char *end) : pos(begin), end(end) {}
+
+    void skipWs()
+    {
+        while (pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t'))
+            ++pos;
+    }
+
+    // skip whitespace, then match c
+    bool consume(char c)
+    {
+        skipWs();
+        if (pos < end && *pos == c)
+        {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c)
+    {
+        skipWs();
+        return pos < end && *pos == c;
+    }
+
+    bool readString(std::string_view &out)
+    {
+        if (!consume('"'))
+            return false;
+        const char *start = pos;
+        while (pos < end && *pos != '"')
+        {
+            if (*pos == '\\' && pos + 1 < end)
+                ++pos;
+            ++pos;
+        }
+        if (pos >= end)
+            return false;
+        out = std::string_view(start, static_cast<std::size_t>(pos - start));
+        ++pos;
+        return true;
+    }
+
+    // reads "key": and leaves the cursor on the value
+    bool readKey(std::string_view &key)
+    {
+        return readString(key) && consume(':');
+    }
+
+    // quoted decimal, the way binance sends prices and quantities
+    bool readQuotedDecimal(Fixed &out)
+    {
+        std::string_view text;
+        return readString(text) && Fixed::parse(text.data(), text.data() + text.size(), out);
+    }
+
+    bool readInt(int64_t &out)
+    {
+        skipWs();
+        bool negative = false;
+        if (pos < end && *pos == '-')
+        {
+            negative = true;
+            ++pos;
+        }
+        const char *start = pos;
+        uint64_t value = 0;
+        while (pos < end && static_cast<unsigned>(*pos - '0') < 10)
+        {
+            value = value * 10 + static_cast<unsigned>(*pos - '0');
+            ++pos;
+        }
+        if (pos == start)
+            return false;
+        out = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+        return true;
+    }
+
+    // skips any value: string, number, literal, object or array
+    bool skipValue()
+    {
+        skipWs();
+        if (pos >= end)
+            return false;
+        if (*pos == '"')
+        {
+            std::string_view ignored;
+            return readString(ignored);
+        }
+        if (*pos == '{' || *pos == '[')
+        {
+            int depth = 0;
+            while (pos < end)
+            {
+                char c = *pos;
+                if (c == '"')
+                {
+                    std::string_view ignored;
+                    if (!readString(ignored))
+                        return false;
+                    continue;
+                }
+                ++pos;
+                if (c == '{' || c == '[')
+                    ++depth;
+                else if (c == '}' || c == ']')
+                {
+                    if (--depth == 0)
+                        return true;
+                }
+            }
+            return false;
+        }
+        // number, true, false, null
+        const char *start = pos;
+        while (pos < end && *pos != ',' && *pos != '}' && *pos != ']' && *pos != ' ' && *pos != '\n')
+            ++pos;
+        return pos != start;
+    }
+
+    // after a value inside an object/array: true if another element follows
+    bool next(char close)
+    {
+        if (consume(','))
+            return true;
+        if (consume(close))
+            return false;
+        failed = true;
+        return false;
+    }
+
+    bool ok() const { return !failed; }
+    const char *position() const { return pos; }
+
+private:
+    const char *pos;
+    const char *end;
+    bool failed = false;
+};
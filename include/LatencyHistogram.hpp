@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// log-linear latency histogram in the spirit of HdrHistogram
+//  - 32 linear sub-buckets per power of two, so every bucket is within ~3% of its values
+//  - fixed footprint, record is a couple of shifts and one counter bump, no allocation
+//  - one writer per instance, counters are relaxed atomics so any thread may read or merge
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned SubBucketBits = 5;
+    static constexpr uint64_t SubBuckets = uint64_t{1} << SubBucketBits;
+    // values are clamped to 2^MaxExponent ns (~68 s)
+    static constexpr unsigned MaxExponent = 36;
+    static constexpr std::size_t BucketCount = (MaxExponent - SubBucketBits + 2) * SubBuckets;
+
+    LatencyHistogram()
+    {
+        reset();
+    }
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    // single writer only
+    void record(uint64_t value)
+    {
+        if (value >= (uint64_t{1} << MaxExponent))
+            value = (uint64_t{1} << MaxExponent) - 1;
+        bump(counts[indexOf(value)], 1);
+        bump(total, 1);
+        if (value > maxValue.load(std::memory_order_relaxed))
+            maxValue.store(value, std::memory_order_relaxed);
+    }
+
+    // not safe against a concurrent writer of this instance, merging from others is fine
+    void add(const LatencyHistogram &other)
+    {
+        for (std::size_t i = 0; i < BucketCount; ++i)
+        {
+            const uint64_t n = other.counts[i].load(std::memory_order_relaxed);
+            if (n != 0)
+                bump(counts[i], n);
+        }
+        bump(total, other.count());
+        if (other.max() > max())
+            maxValue.store(other.max(), std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        for (auto &c : counts)
+            c.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+
+    // highest value equivalent to the bucket holding the q-th quantile, q in [0, 1]
+    uint64_t percentile(double q) const
+    {
+        const uint64_t n = count();
+        if (n == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(n) + 0.5);
+        if (rank < 1)
+            rank = 1;
+        if (rank > n)
+            rank = n;
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < BucketCount; ++i)
+        {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                const uint64_t upper = upperBound(i);
+                return upper < max() ? upper : max();
+            }
+        }
+        return max();
+    }
+
+private:
+    static void bump(std::atomic<uint64_t> &c, uint64_t n)
+    {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static std::size_t indexOf(uint64_t value)
+    {
+        if (value < SubBuckets)
+            return static_cast<std::size_t>(value);
+        const unsigned exponent = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        const unsigned shift = exponent - SubBucketBits;
+        return static_cast<std::size_t>((shift + 1) * SubBuckets + ((value >> shift) - SubBuckets));
+    }
+
+    static uint64_t upperBound(std::size_t index)
+    {
+        if (index < SubBuckets)
+            return index;
+        const uint64_t shift = index / SubBuckets - 1;
+        const uint64_t sub = index % SubBuckets;
+        return ((SubBuckets + sub + 1) << shift) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, BucketCount> counts;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> maxValue;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// tick-to-trade stage timestamps, aggregated into per-stage LatencyHistograms
+//  - the feed thread marks the origin when a frame lands, every later stage records its
+//    distance from that origin, so each histogram reads as "frame received -> stage"
+//  - the origin is thread-local; StrategyPipeline carries it across to the strategy thread
+//    and OrderManager stores it with the order for the write completion and the ack
+//  - timestamps come from the TSC on x86 (calibrated against steady_clock once), steady_clock elsewhere
+//  - every call site goes through the HFT_TRACE_* macros, which compile to nothing unless
+//    HFT_LATENCY_TRACE is defined; the cmake option is ON by default, -DHFT_LATENCY_TRACE=OFF strips them
+namespace LatencyTrace
+{
+    enum class Stage : uint8_t
+    {
+        Parsed,
+        Signal,
+        RiskApproved,
+        Serialized,
+        WriteDone,
+        Ack,
+        Count
+    };
+
+    const char *stageName(Stage stage);
+
+    // raw clock ticks, only differences are meaningful
+    int64_t now();
+    // measures the tick rate, called once at startup so the first record does not pay for it
+    void calibrate();
+
+    int64_t origin();
+    void setOrigin(int64_t ticks);
+
+    // no-op for a zero origin, e.g. frames that came from a replay rather than the socket
+    void record(Stage stage, int64_t origin);
+
+    // count, p50 .. p99.99 and max per stage in microseconds, merged over all threads
+    void report(std::ostream &os);
+}
+
+#ifdef HFT_LATENCY_TRACE
+#define HFT_TRACE_INIT() LatencyTrace::calibrate()
+#define HFT_TRACE_FRAME() LatencyTrace::setOrigin(LatencyTrace::now())
+#define HFT_TRACE_ORIGIN() LatencyTrace::origin()
+#define HFT_TRACE_SET_ORIGIN(ticks) LatencyTrace::setOrigin(ticks)
+#define HFT_TRACE_STAGE(stage) LatencyTrace::record(LatencyTrace::Stage::stage, LatencyTrace::origin())
+#define HFT_TRACE_STAGE_FROM(stage, ticks) LatencyTrace::record(LatencyTrace::Stage::stage, ticks)
+#define HFT_TRACE_REPORT(os) LatencyTrace::report(os)
+#else
+#define HFT_TRACE_INIT() ((void)0)
+#define HFT_TRACE_FRAME() ((void)0)
+#define HFT_TRACE_ORIGIN() (int64_t{0})
+#define HFT_TRACE_SET_ORIGIN(ticks) ((void)(ticks))
+#define HFT_TRACE_STAGE(stage) ((void)0)
+#define HFT_TRACE_STAGE_FROM(stage, ticks) ((void)(ticks))
+#define HFT_TRACE_REPORT(os) ((void)0)
+#endif
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <Fixed.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// asynchronous binary logger, the calling thread never formats or touches a file
+//  - every call site is a static Log::Site holding the level, file, line and format string; a call
+//    copies only the site id, a timestamp and the raw argument bytes into its thread's ring
+//  - a background thread drains every ring, prints formatted text to the console and appends the
+//    records untouched to a binary file, which log_decode turns back into text
+//  - a full ring drops the record and counts it, callers never block
+//  - call sites below HFT_LOG_LEVEL compile to nothing (cmake -DHFT_LOG_LEVEL=DEBUG|INFO|WARN|ERROR|OFF)
+//  - format strings take one {} per argument; arguments are integers, enums, floating point, Fixed,
+//    chars and strings (copied, cut at MaxString bytes)
+//  - before start() and after stop() every call returns straight away
+namespace Log
+{
+    enum class Level : uint8_t
+    {
+        Debug,
+        Info,
+        Warn,
+        Error
+    };
+
+    const char *levelName(Level level);
+
+    class Site
+    {
+    public:
+        constexpr Site(Level level, const char *file, int line, const char *format)
+            : level(level), file(file), line(line), format(format) {}
+
+        Site(const Site &) = delete;
+        Site &operator=(const Site &) = delete;
+
+        const Level level;
+        const char *const file;
+        const int line;
+        const char *const format;
+        // one tag per argument, see detail::tagOf; set once when the site registers
+        const char *tags = nullptr;
+        // 0 until the first call registers the site
+        std::atomic<uint32_t> id{0};
+    };
+
+    struct Options
+    {
+        // binary log file, empty logs to the console only
+        std::string path;
+        // formatted text on stdout, warnings and errors on stderr
+        bool console = true;
+        // ring per logging thread, rounded up to a power of two
+        std::size_t threadBufferBytes = std::size_t(1) << 20;
+    };
+
+    // throws std::runtime_error if the file cannot be opened
+    void start(const Options &options);
+    // drains every ring, then closes the file
+    void stop();
+    // records lost to full rings, over all threads
+    uint64_t dropped();
+
+    // binary file: FileHeader, then back-to-back records, each padded to 8 bytes
+    //  - RecordHeader followed by `length` payload bytes
+    //  - site 0 defines a site before its first entry: SiteHeader, then the file, format and
+    //    argument tags, each NUL terminated
+    //  - entries carry their site's arguments in order: 8 bytes per number, strings as a
+    //    uint32_t length and the bytes
+    //  - the writer drains one thread's ring at a time, entries from different threads are only
+    //    ordered by their timestamps
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+    };
+
+    struct RecordHeader
+    {
+        // CLOCK_REALTIME nanoseconds at the call; clock ticks while still in a thread's ring
+        int64_t timeNs;
+        uint32_t site;
+        uint32_t length;
+    };
+
+    struct SiteHeader
+    {
+        uint32_t id;
+        uint32_t line;
+        Level level;
+    };
+
+    inline constexpr char Magic[8] = {'H', 'F', 'T', 'L', 'O', 'G', '0', '1'};
+    inline constexpr uint32_t Version = 1;
+    inline constexpr std::size_t MaxString = 1024;
+
+    constexpr std::size_t padded(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+    // appends the message for one entry's payload; false if the payload does not match the tags
+    bool format(std::string &out, const char *format, const char *tags, const char *args, std::size_t length);
+    // a binary log as text, one line per entry in timestamp order; false if the file is not a log
+    bool decode(const std::string &path, std::ostream &os);
+
+    namespace detail
+    {
+        // names the arguments of a call site below HFT_LOG_LEVEL, never called
+        template <typename... Args>
+        inline void discard(const Args &...) {}
+
+        // per-thread spsc byte ring, the logging thread produces and the writer consumes
+        struct Buffer
+        {
+            explicit Buffer(std::size_t capacity);
+            ~Buffer();
+
+            void copyIn(uint64_t at, const void *src, std::size_t n)
+            {
+                const std::size_t offset = at & mask;
+                const std::size_t first = std::min(n, capacity - offset);
+                std::memcpy(data + offset, src, first);
+                if (first < n)
+                    std::memcpy(data, static_cast<const char *>(src) + first, n - first);
+            }
+
+            char *data;
+            std::size_t capacity;
+            std::size_t mask;
+            alignas(64) std::atomic<uint64_t> head{0};
+            // producer's last look at tail, refreshed only when the ring seems full
+            uint64_t cachedTail = 0;
+            std::atomic<uint64_t> dropped{0};
+            alignas(64) std::atomic<uint64_t> tail{0};
+        };
+
+        inline std::atomic<bool> active{false};
+
+        uint32_t registerSite(Site &site, const char *tags);
+        // creates and registers the calling thread's ring
+        Buffer *attach();
+
+        inline Buffer *&localBuffer()
+        {
+            thread_local Buffer *mine = nullptr;
+            return mine;
+        }
+
+        // record timestamp in raw clock ticks, the writer turns them into wall time
+        inline int64_t now()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            return static_cast<int64_t>(__rdtsc());
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+#endif
+        }
+
+        template <typename>
+        inline constexpr bool Unsupported = false;
+
+        // i signed, u unsigned, d floating point, f Fixed, c char, s string
+        template <typename T>
+        constexpr char tagOf()
+        {
+            using U = std::remove_cv_t<std::remove_reference_t<T>>;
+            if constexpr (std::is_same_v<U, Fixed>)
+                return 'f';
+            else if constexpr (std::is_same_v<U, char>)
+                return 'c';
+            else if constexpr (std::is_enum_v<U>)
+                return tagOf<std::underlying_type_t<U>>();
+            else if constexpr (std::is_integral_v<U>)
+                return std::is_signed_v<U> ? 'i' : 'u';
+            else if constexpr (std::is_floating_point_v<U>)
+                return 'd';
+            else if constexpr (std::is_convertible_v<const U &, std::string_view>)
+                return 's';
+            else
+                static_assert(Unsupported<U>, "unsupported log argument type");
+        }
+
+        template <typename... Args>
+        struct Tags
+        {
+            static constexpr char value[sizeof...(Args) + 1] = {tagOf<Args>()..., '\0'};
+        };
+
+        template <typename T>
+        std::string_view asString(const T &value)
+        {
+            if constexpr (std::is_pointer_v<T>)
+            {
+                if (value == nullptr)
+                    return "(null)";
+            }
+            std::string_view text(value);
+            return text.substr(0, MaxString);
+        }
+
+        template <typename T>
+        std::size_t encodedSize(const T &value)
+        {
+            if constexpr (tagOf<T>() == 's')
+                return sizeof(uint32_t) + asString(value).size();
+            else
+                return sizeof(uint64_t);
+        }
+
+        template <typename T>
+        void put(Buffer &buffer, uint64_t &at, const T &value)
+        {
+            constexpr char tag = tagOf<T>();
+            if constexpr (tag == 's')
+            {
+                const std::string_view text = asString(value);
+                const auto size = static_cast<uint32_t>(text.size());
+                buffer.copyIn(at, &size, sizeof(size));
+                buffer.copyIn(at + sizeof(size), text.data(), text.size());
+                at += sizeof(size) + text.size();
+                return;
+            }
+            else if constexpr (tag == 'f')
+            {
+                buffer.copyIn(at, &value.units, sizeof(value.units));
+            }
+            else if constexpr (tag == 'd')
+            {
+                const double v = static_cast<double>(value);
+                buffer.copyIn(at, &v, sizeof(v));
+            }
+            else if constexpr (tag == 'i')
+            {
+                const auto v = static_cast<int64_t>(value);
+                buffer.copyIn(at, &v, sizeof(v));
+            }
+            else if constexpr (tag == 'c')
+            {
+                const uint64_t v = static_cast<unsigned char>(value);
+                buffer.copyIn(at, &v, sizeof(v));
+            }
+            else
+            {
+                const auto v = static_cast<uint64_t>(value);
+                buffer.copyIn(at, &v, sizeof(v));
+            }
+            at += sizeof(uint64_t);
+        }
+    }
+
+    template <typename... Args>
+    void write(Site &site, const Args &...args)
+    {
+        if (!detail::active.load(std::memory_order_relaxed))
+            return;
+        uint32_t id = site.id.load(std::memory_order_acquire);
+        if (id == 0)
+            id = detail::registerSite(site, detail::Tags<Args...>::value);
+        detail::Buffer *buffer = detail::localBuffer();
+        if (buffer == nullptr)
+            buffer = detail::attach();
+
+        const std::size_t length = (std::size_t(0) + ... + detail::encodedSize(args));
+        const std::size_t total = sizeof(RecordHeader) + padded(length);
+        const uint64_t h = buffer->head.load(std::memory_order_relaxed);
+        if (total > buffer->capacity - (h - buffer->cachedTail))
+        {
+            buffer->cachedTail = buffer->tail.load(std::memory_order_acquire);
+            if (total > buffer->capacity - (h - buffer->cachedTail))
+            {
+                buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        const RecordHeader record{detail::now(), id, static_cast<uint32_t>(length)};
+        buffer->copyIn(h, &record, sizeof(record));
+        // untouched by the fold when there are no arguments
+        [[maybe_unused]] uint64_t at = h + sizeof(record);
+        (detail::put(*buffer, at, args), ...);
+        // padding bytes are whatever the ring held before, nothing reads them
+        buffer->head.store(h + total, std::memory_order_release);
+    }
+}
+
+#define HFT_LOG_LEVEL_DEBUG 0
+#define HFT_LOG_LEVEL_INFO 1
+#define HFT_LOG_LEVEL_WARN 2
+#define HFT_LOG_LEVEL_ERROR 3
+#define HFT_LOG_LEVEL_OFF 4
+
+#ifndef HFT_LOG_LEVEL
+#define HFT_LOG_LEVEL HFT_LOG_LEVEL_INFO
+#endif
+
+#define HFT_LOG_AT(level, fmt, ...)                                                   \
+    do                                                                                \
+    {                                                                                 \
+        static ::Log::Site hftLogSite(::Log::Level::level, __FILE__, __LINE__, fmt); \
+        ::Log::write(hftLogSite, ##__VA_ARGS__);                                      \
+    } while (0)
+
+// disabled levels still name their arguments, so nothing becomes unused, but never evaluate them
+#define HFT_LOG_DISCARD(...)                      \
+    do                                            \
+    {                                             \
+        if (false)                                \
+            ::Log::detail::discard(__VA_ARGS__);  \
+    } while (0)
+
+#if HFT_LOG_LEVEL <= HFT_LOG_LEVEL_DEBUG
+#define HFT_LOG_DEBUG(...) HFT_LOG_AT(Debug, __VA_ARGS__)
+#else
+#define HFT_LOG_DEBUG(...) HFT_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if HFT_LOG_LEVEL <= HFT_LOG_LEVEL_INFO
+#define HFT_LOG_INFO(...) HFT_LOG_AT(Info, __VA_ARGS__)
+#else
+#define HFT_LOG_INFO(...) HFT_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if HFT_LOG_LEVEL <= HFT_LOG_LEVEL_WARN
+#define HFT_LOG_WARN(...) HFT_LOG_AT(Warn, __VA_ARGS__)
+#else
+#define HFT_LOG_WARN(...) HFT_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if HFT_LOG_LEVEL <= HFT_LOG_LEVEL_ERROR
+#define HFT_LOG_ERROR(...) HFT_LOG_AT(Error, __VA_ARGS__)
+#else
+#define HFT_LOG_ERROR(...) HFT_LOG_DISCARD(__VA_ARGS__)
+#endif
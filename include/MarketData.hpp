@@ -6,11 +6,22 @@
 #include <nlohmann/json.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <SymbolRegistry.hpp>
+#include <OrderBook.hpp>
+#include <DepthDiffParser.hpp>
+#include <SnapshotSource.hpp>
+#include <WsConnection.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <thread>
 #include <atomic>
 #include <algorithm>
+#include <chrono>
 #include <cctype>
 #include <functional>
 
@@ -21,50 +32,202 @@ namespace ws = beast::websocket;
 using tcp = asio::ip::tcp;
 using json = nlohmann::json;
 
+class MarketDataJournal;
+
+// session counters and what the outages cost, readable from any thread
+struct FeedStats
+{
+    WsConnection::Stats connection;
+    // diff feed only: book update ids skipped between the last diff before a drop and the first
+    // one after, summed over symbols. bookTicker ids are not contiguous per symbol, its outages
+    // are the drop count and durations in connection
+    uint64_t missedUpdates;
+};
+
 class MarketData
 {
 public:
-    MarketData(asio::io_context &ioc, ssl::context &ssl_ctx, std::string host, std::string port, std::vector<std::string> &symbols);
+    // the session runs on ioc, whichever thread drives it (see ExecutionContext)
+    MarketData(asio::io_context &ioc, ssl::context &ssl_ctx, std::string host, std::string port, const SymbolRegistry &registry, std::vector<SymbolId> symbols);
+    // opens the session
     void run();
+    // closes the session and waits for it, ioc keeps running for whatever else is on it
     void stop();
 
-    struct Level
+    // depth subscribed on the wire, also the inline capacity of an Update
+    static constexpr std::size_t Depth = 5;
+
+    using Level = PriceLevel;
+
+    // one side of the book held inline, best level first
+    struct Levels
     {
-        double price;
-        double quantity;
+        std::array<Level, Depth> levels;
+        uint8_t count = 0;
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        bool full() const { return count == Depth; }
+        void clear() { count = 0; }
+        void push_back(const Level &level) { levels[count++] = level; }
+        const Level &operator[](std::size_t i) const { return levels[i]; }
+        const Level *begin() const { return levels.data(); }
+        const Level *end() const { return levels.data() + count; }
     };
+
+    // trivially copyable, safe to memcpy into queues and journals
     struct Update
     {
-        std::string symbol;
-        std::vector<Level> bids;
-        std::vector<Level> asks;
+        SymbolId symbol = InvalidSymbol;
+        Levels bids;
+        Levels asks;
 
+        // NaN while either side is empty, the levels array is reused so [0] may hold an old frame
         double midPrice() const
         {
-            return (bids[0].price + asks[0].price) * 0.5;
+            if (bids.empty() || asks.empty())
+                return std::numeric_limits<double>::quiet_NaN();
+            return (bids[0].price + asks[0].price).toDouble() * 0.5;
         }
     };
 
+    // <sym>@bookTicker, best bid/ask only
+    struct TopOfBook
+    {
+        SymbolId symbol = InvalidSymbol;
+        int64_t updateId = 0;
+        Level bid;
+        Level ask;
+
+        double midPrice() const
+        {
+            return (bid.price + ask.price).toDouble() * 0.5;
+        }
+    };
+
+    enum class Feed
+    {
+        // <sym>@depth5 partial snapshots
+        Depth5,
+        // <sym>@depth@100ms diffs folded into a full OrderBook per symbol
+        DiffDepth,
+        // <sym>@bookTicker, delivered through onTopOfBook only
+        BookTicker
+    };
+
+    // pick the stream before run(), DiffDepth needs a snapshot source to sync against
+    void setFeed(Feed feed, SnapshotSource *snapshots = nullptr);
+    Feed currentFeed() const { return feed; }
+
+    enum class Encoding
+    {
+        // text frames from stream.binance.com
+        Json,
+        // binary frames from stream-sbe.binance.com, see SbeParser; Depth5 subscribes to
+        // @depth20 and keeps the best Depth levels, BookTicker to @bestBidAsk, DiffDepth to @depth
+        Sbe
+    };
+
+    // before run(); the SBE endpoint wants an api key on the upgrade request
+    void setEncoding(Encoding encoding, const std::string &apiKey = {});
+    Encoding currentEncoding() const { return encoding; }
+
+    // journal every received frame (and DiffDepth snapshots), or the decoded events instead
+    void record(MarketDataJournal *journal, bool decoded = false);
+
+    // decode one frame as if it came off the socket, used by the live path and by replay
+    void processFrame(const char *data, std::size_t size);
+    // hand a decoded event to the registered callback
+    void deliver(const Update &upd);
+    void deliver(const TopOfBook &tob);
+
     void onUpdate(std::function<void(const Update &)> cb);
+    void onTopOfBook(std::function<void(const TopOfBook &)> cb);
+
+    // full book in DiffDepth mode, only read it from the update callback
+    const OrderBook &book(SymbolId symbol) const;
+    // times a symbol's book had to be rebuilt after a sequence gap
+    uint64_t resyncCount(SymbolId symbol) const;
+
+    // socket options and reconnect backoff, before run()
+    void setConnectionSettings(const WsConnection::Settings &settings);
+    FeedStats feedStats() const;
 
 private:
-    void doResolve();
-    void onResolve(beast::error_code ec, tcp::resolver::results_type results);
-    void onConnect(beast::error_code ec, tcp::endpoint);
-    void onSslHandShake(beast::error_code ec);
-    void onWsHandshake(beast::error_code ec);
-    void onRead(beast::error_code ec, std::size_t bytes_transferred);
+    static constexpr int SyncBackoffMinMs = 100;
+    static constexpr int SyncBackoffMaxMs = 10000;
+
+    struct BookState
+    {
+        OrderBook book;
+        bool synced = false;
+        // next diff must straddle the snapshot id rather than continue from it
+        bool bridging = false;
+        uint64_t resyncs = 0;
+        // diffs received while waiting for a usable snapshot
+        std::vector<DepthDiff> pending;
+        // snapshot fetches block the feed thread, so they are spaced out per symbol: the next one
+        // waits until nextSync, and the wait doubles from SyncBackoffMinMs up to SyncBackoffMaxMs
+        // until the book stays in sync for SyncBackoffMaxMs
+        std::chrono::steady_clock::time_point nextSync;
+        std::chrono::steady_clock::time_point syncedAt;
+        int syncBackoffMs = SyncBackoffMinMs;
+    };
+
+    enum class Sequence
+    {
+        Stale,
+        Apply,
+        Gap
+    };
+
+    void handleDiff();
+    bool syncBook(SymbolId symbol);
+    Sequence checkSequence(const BookState &state, const DepthDiff &diff) const;
+    void applyDiff(BookState &state, const DepthDiff &diff);
+    void publishBook(SymbolId symbol);
+
+    // the subscription is in the target, so a reconnect resubscribes by itself
+    void onOpen(bool reconnected);
+    void onFrame(const char *data, std::size_t size);
+    // first id seen per symbol after a reconnect against the last one before it
+    void measureGap(SymbolId symbol, int64_t firstId);
+    // decode into update / diff / topOfBook per the encoding, false on a malformed frame
+    bool decodeDepth5(const char *data, std::size_t size);
+    bool decodeDiff(const char *data, std::size_t size);
+    bool decodeTopOfBook(const char *data, std::size_t size);
+    // feed byte for journal records, tagged for SBE
+    uint8_t journalFeed() const;
     std::string buildTarget() const;
 
-    asio::io_context &ioc;
-    tcp::resolver resolver;
-    ws::stream<ssl::stream<tcp::socket>> ws;
-    beast::flat_buffer buffer;
-    std::string host;
-    ssl::context &ssl_ctx;
-    std::string port;
-    std::vector<std::string> symbols;
-    std::thread thread;
+    const SymbolRegistry &registry;
+    WsConnection connection;
+    std::vector<SymbolId> symbols;
     std::atomic<bool> running{false};
     std::function<void(const Update &)> updateCallback;
-};
\ No newline at end of file
+    std::function<void(const TopOfBook &)> topOfBookCallback;
+    // decoded in place every frame, keeps its capacity between frames
+    Update update;
+    TopOfBook topOfBook;
+
+    Feed feed = Feed::Depth5;
+    Encoding encoding = Encoding::Json;
+    SnapshotSource *snapshots = nullptr;
+    // indexed by SymbolId, only populated in DiffDepth mode
+    std::vector<BookState> books;
+    DepthDiff diff;
+    DepthDiff snapshot;
+
+    MarketDataJournal *journal = nullptr;
+    bool journalDecoded = false;
+
+    // last diff update id per symbol, 0 before the first diff
+    std::vector<int64_t> lastUpdateIds;
+    // symbols still owed their first frame since the reconnect
+    std::size_t gapsOpen = 0;
+    std::vector<bool> gapOpen;
+    std::atomic<uint64_t> missedUpdates{0};
+};
+
+static_assert(std::is_trivially_copyable<MarketData::Update>::value, "MarketData::Update must stay memcpy-able");
+static_assert(std::is_trivially_copyable<MarketData::TopOfBook>::value, "MarketData::TopOfBook must stay memcpy-able");
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <SymbolRegistry.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// append-only binary journal of everything MarketData receives
+//  - file: FileHeader, then back-to-back records, each padded to 8 bytes
+//  - record: RecordHeader followed by `length` payload bytes
+//  - the feed thread only copies into a preallocated ring, a background thread batches the
+//    writes to disk; when the ring is full the record is dropped and counted, never blocked on
+class MarketDataJournal
+{
+public:
+    enum class RecordKind : uint8_t
+    {
+        // symbol name for `symbol`, written once per registry entry at open
+        Symbol = 1,
+        // raw websocket frame as received
+        Frame = 2,
+        // /depth snapshot body a DiffDepth book synced against
+        Snapshot = 3,
+        // decoded MarketData::Update / TopOfBook, memcpy of the struct
+        Update = 4,
+        TopOfBook = 5
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+    };
+
+    struct RecordHeader
+    {
+        // receive time, CLOCK_REALTIME nanoseconds
+        int64_t recvNs;
+        uint32_t length;
+        RecordKind kind;
+        // MarketData::Feed the frame came from, | SbeFeed for binary frames
+        uint8_t feed;
+        SymbolId symbol;
+    };
+
+    static constexpr uint8_t SbeFeed = 0x80;
+
+    static constexpr char Magic[8] = {'H', 'F', 'T', 'M', 'D', 'J', 'N', 'L'};
+    // 2: decoded records carry Fixed prices and quantities
+    static constexpr uint32_t Version = 2;
+
+    static constexpr std::size_t padded(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+    // ringBytes is rounded up to a power of two; throws std::runtime_error if the file cannot be opened
+    MarketDataJournal(const std::string &path, const SymbolRegistry &registry, std::size_t ringBytes = std::size_t(64) << 20);
+    ~MarketDataJournal();
+
+    MarketDataJournal(const MarketDataJournal &) = delete;
+    MarketDataJournal &operator=(const MarketDataJournal &) = delete;
+
+    // single producer: call from the feed thread only
+    bool append(RecordKind kind, uint8_t feed, SymbolId symbol, int64_t recvNs, const void *data, std::size_t length);
+
+    // drains whatever is queued and closes the file
+    void stop();
+
+    uint64_t dropped() const { return droppedRecords.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return written.load(std::memory_order_relaxed); }
+
+    static int64_t now();
+
+private:
+    void copyIn(uint64_t at, const void *src, std::size_t n);
+    void writerLoop();
+    bool flush();
+
+    int fd = -1;
+    std::vector<char> ring;
+    std::size_t mask;
+    // producer owns head, writer owns tail
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> droppedRecords{0};
+    std::atomic<uint64_t> written{0};
+    std::atomic<bool> running{false};
+    std::thread writer;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Fixed.hpp>
+#include <SymbolRegistry.hpp>
+#include <cstdint>
+
+// generation << 32 | slot in the OrderStore, 0 is never issued
+using OrderId = uint64_t;
+constexpr OrderId InvalidOrderId = 0;
+
+enum class OrderSide
+{
+    BUY,
+    SELL
+};
+enum class OrderStatus
+{
+    NEW,
+    ACKED,
+    PARTIAL,
+    FILLED,
+    CANCELED,
+    REJECTED
+};
+
+struct Order
+{
+    SymbolId symbol = InvalidSymbol;
+    OrderId id = InvalidOrderId;
+    OrderSide side;
+    // still open, i.e. what is left after fills
+    Fixed quantity;
+    Fixed price;
+    OrderStatus status;
+
+    // for partial fills
+    Fixed lastFillQuantity;
+    Fixed lastFillPrice;
+
+    // LatencyTrace origin of the frame that triggered the order, 0 when untraced
+    int64_t traceOrigin = 0;
+
+    // order this one is taking over from in an order.cancelReplace, InvalidOrderId for a plain place
+    OrderId replaces = InvalidOrderId;
+};
+
+// what a strategy asks for, OrderManager turns it into an Order and assigns the id
+struct OrderRequest
+{
+    SymbolId symbol = InvalidSymbol;
+    OrderSide side;
+    Fixed quantity;
+    Fixed price;
+};
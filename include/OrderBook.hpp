@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Fixed.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PriceLevel
+{
+    Fixed price;
+    Fixed quantity;
+};
+
+// full-depth L2 book on flat sorted arrays
+//  - each side is stored worst -> best, so the touch sits at the back of the array
+//  - updates near the touch (the common case) shift only a few elements
+//  - level(i) views are plain index math, O(1)
+class OrderBook
+{
+public:
+    explicit OrderBook(std::size_t reserveLevels = 1024);
+
+    void clear();
+
+    // quantity 0 removes the level
+    void updateBid(Fixed price, Fixed quantity);
+    void updateAsk(Fixed price, Fixed quantity);
+
+    std::size_t bidDepth() const { return bids.size(); }
+    std::size_t askDepth() const { return asks.size(); }
+    bool empty() const { return bids.empty() || asks.empty(); }
+
+    // i = 0 is the best level, caller checks depth
+    const PriceLevel &bid(std::size_t i) const { return bids[bids.size() - 1 - i]; }
+    const PriceLevel &ask(std::size_t i) const { return asks[asks.size() - 1 - i]; }
+
+    double midPrice() const { return (bid(0).price + ask(0).price).toDouble() * 0.5; }
+
+    // last exchange update id folded into the book
+    int64_t lastUpdateId = 0;
+
+private:
+    // bids ascending, asks descending
+    std::vector<PriceLevel> bids;
+    std::vector<PriceLevel> asks;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Order.hpp>
+#include <SymbolRegistry.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ws-api order.place / order.cancel / order.cancelReplace / order.status writer without json objects or heap allocation
+//  - the constant parts of each message are rendered per symbol once, at construction
+//  - encoding copies those segments into the caller's buffer and fills the id, side,
+//    quantity and price in between
+//  - buy prices round down and sell prices up to the tick, quantities down to the lot, all in integer math and printed
+//    straight from the Fixed units
+class OrderEncoder
+{
+public:
+    // comfortably above any order.place we send: ids, symbol and two numbers
+    static constexpr std::size_t MaxMessageSize = 512;
+
+    // every symbol's filters have to be set before this, the templates are fixed afterwards
+    explicit OrderEncoder(const SymbolRegistry &registry);
+
+    // bytes written, 0 when the symbol is unknown, the quantity rounds to nothing or out is too small
+    std::size_t encodePlace(char *out, std::size_t capacity, std::string_view clientId, SymbolId symbol,
+                            OrderSide side, Fixed quantity, Fixed price) const;
+    std::size_t encodeCancel(char *out, std::size_t capacity, std::string_view clientId, SymbolId symbol) const;
+    // current state of clientId as the exchange sees it, the request id carries a "_status" suffix
+    std::size_t encodeStatus(char *out, std::size_t capacity, std::string_view clientId, SymbolId symbol) const;
+    // atomic cancel of origClientId and place of clientId, the new order is only attempted once the
+    // cancel went through (STOP_ON_FAILURE)
+    std::size_t encodeCancelReplace(char *out, std::size_t capacity, std::string_view clientId, std::string_view origClientId,
+                                    SymbolId symbol, OrderSide side, Fixed quantity, Fixed price) const;
+
+private:
+    // place when origClientId is empty, cancel-replace otherwise
+    std::size_t encodeNew(char *out, std::size_t capacity, std::string_view clientId, std::string_view origClientId,
+                          SymbolId symbol, OrderSide side, Fixed quantity, Fixed price) const;
+    // cancel and status: request id, the symbol's method text, then origClientOrderId
+    std::size_t encodeById(char *out, std::size_t capacity, std::string_view clientId, const std::string &methodSymbol) const;
+
+    struct Template
+    {
+        // text between the request id and the side, carries the symbol
+        std::string placeSymbol;
+        // text between the request id and origClientOrderId's value
+        std::string cancelSymbol;
+        // same for order.status
+        std::string statusSymbol;
+        // text between the request id and cancelOrigClientOrderId's value
+        std::string amendSymbol;
+        // steps in Fixed units
+        int64_t tickUnits;
+        int64_t lotUnits;
+        uint8_t priceDecimals;
+        uint8_t quantityDecimals;
+    };
+
+    std::vector<Template> templates;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Order.hpp>
+#include <SpscRing.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// anything that follows order state: risk, pnl, strategies, journals, the console
+class OrderListener
+{
+public:
+    virtual ~OrderListener() = default;
+    virtual void onOrderUpdate(const Order &order) = 0;
+};
+
+// fans every order update out to any number of listeners
+//  - inline listeners run on the publishing thread, in subscription order, with the Order passed
+//    by reference: no std::function, no copy, no allocation per event
+//  - async listeners get a copy through an SpscRing drained by a dispatcher thread, so a slow one
+//    (console log, journal) never holds up the ack path; a full ring drops and counts the event
+//  - subscribe everything before start(), the listener lists are not guarded afterwards
+//  - publish() from one thread only, OrderManager calls it from its socket strand
+class OrderEventDispatcher
+{
+public:
+    struct Options
+    {
+        std::size_t asyncCapacity = 4096;
+        // cpu for the dispatcher thread, -1 leaves it unpinned
+        int core = -1;
+    };
+
+    OrderEventDispatcher();
+    explicit OrderEventDispatcher(Options options);
+    ~OrderEventDispatcher();
+
+    OrderEventDispatcher(const OrderEventDispatcher &) = delete;
+    OrderEventDispatcher &operator=(const OrderEventDispatcher &) = delete;
+
+    void subscribe(OrderListener &listener);
+    void subscribeAsync(OrderListener &listener);
+
+    // the dispatcher thread, only spawned when there is an async listener
+    void start();
+    // delivers whatever is already queued, then joins
+    void stop();
+
+    void publish(const Order &order);
+
+    // async events lost to a full ring
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    void poll();
+    void deliverAsync(const Order &order);
+
+    Options options;
+    std::vector<OrderListener *> inlineListeners;
+    std::vector<OrderListener *> asyncListeners;
+    SpscRing<Order> ring;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> droppedCount{0};
+};
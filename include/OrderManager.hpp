@@ -6,29 +6,24 @@
 #include <nlohmann/json.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <SymbolRegistry.hpp>
+#include <Order.hpp>
+#include <OrderEncoder.hpp>
+#include <OrderStore.hpp>
+#include <OrderScheduler.hpp>
+#include <OrderEventDispatcher.hpp>
+#include <LatencyHistogram.hpp>
+#include <WsConnection.hpp>
 #include <string>
 #include <mutex>
 #include <atomic>
-#include <unordered_map>
 #include <functional>
 #include <algorithm>
 #include <cctype>
 #include <thread>
-
-enum class OrderSide
-{
-    BUY,
-    SELL
-};
-enum class OrderStatus
-{
-    NEW,
-    ACKED,
-    PARTIAL,
-    FILLED,
-    CANCELED,
-    REJECTED
-};
+#include <array>
+#include <memory>
+#include <vector>
 
 namespace ssl = boost::asio::ssl;
 namespace asio = boost::asio;
@@ -37,70 +32,145 @@ namespace ws = beast::websocket;
 using tcp = asio::ip::tcp;
 using json = nlohmann::json;
 
-struct Order
+// outbound queue counters, readable from any thread
+struct OutboxStats
 {
-    std::string symbol;
-    std::string clientId;
-    OrderSide side;
-    double quantity;
-    double price;
-    OrderStatus status;
-
-    // for partial fills
-    double lastFillQuantity = 0.0;
-    double lastFillPrice = 0.0;
+    std::size_t depth;
+    std::size_t maxDepth;
+    uint64_t written;
+    // enqueue to write start, i.e. how long a message waited behind the write in flight
+    uint64_t queuedP50Ns;
+    uint64_t queuedP99Ns;
+    uint64_t queuedMaxNs;
 };
 
-class OrderManager
+// rate-limit scheduler counters, readable from any thread
+struct SchedulerStats
 {
-    // type aliasing for any callable that takes in order
-    using OrderCallback = std::function<void(const Order &)>;
+    std::size_t queued;
+    // unsent orders replaced by a newer one for the same symbol and side
+    uint64_t superseded;
+    // times the queue had work but every message would have broken a limit
+    uint64_t throttled;
+    // see OrderManager::orderHeadroom
+    std::size_t orderHeadroom;
+};
 
+class OrderManager
+{
 public:
-    explicit OrderManager(asio::io_context &ioc, ssl::context &sll_ctx, std::string host, std::string port);
+    // the session runs on ioc, whichever thread drives it (see ExecutionContext)
+    explicit OrderManager(asio::io_context &ioc, ssl::context &sll_ctx, std::string host, std::string port, const SymbolRegistry &registry);
     ~OrderManager();
-    // returns client Id
-    std::string sendOrder(OrderSide side, double quantity, double price, const std::string &symbol);
-    // void cancelOrder(const std::string& clientId);
+    // returns the order id, OrderStore::formatId gives its wire form
+    OrderId sendOrder(OrderSide side, Fixed quantity, Fixed price, SymbolId symbol);
+    // legs cross to the socket strand together and are written back to back, e.g. both sides
+    // of a pair trade; ids[i] receives the id of requests[i]
+    void sendOrders(const OrderRequest *requests, std::size_t count, OrderId *ids);
+    OutboxStats outboxStats() const;
+    SchedulerStats schedulerStats() const;
+    // new orders the exchange still takes in its tightest window, SIZE_MAX until it has reported
+    // limits; strategies back off when this runs short instead of collecting rejects
+    std::size_t orderHeadroom() const;
+
+    // every order state change goes out here; subscribe before run(), which starts the
+    // dispatcher thread for async listeners
+    OrderEventDispatcher &orderEvents() { return events; }
 
-    // gets the update order object after some status
-    void onOrderUpdate(OrderCallback cb);
+    void cancelOrder(OrderId id);
+    // re-prices a resting order with one order.cancelReplace instead of a cancel and a fresh place,
+    // so there is no gap without a quote; returns the id of the replacement, which keeps the
+    // original's symbol and side, or InvalidOrderId when the original is no longer live
+    OrderId amendOrder(OrderId id, Fixed quantity, Fixed price);
+    void handleExchangeAcknowledge(OrderId id, Fixed filledQuantity, Fixed filledPrice, bool success);
+    void handleCancelAcknowledge(OrderId id, bool success);
+    // both legs of an order.cancelReplace answer, id is the replacement
+    void handleCancelReplaceAcknowledge(OrderId id, const json &response);
+    // order.status answer for an order whose outcome was lost with the session
+    void handleStatus(OrderId id, const json &response);
 
-    void cancelOrder(const std::string &clientId);
-    void handleExchangeAcknowledge(const std::string &clientId, double filledQuantity, double filledPrice, bool success);
+    // socket options and reconnect backoff, before run()
+    void setConnectionSettings(const WsConnection::Settings &settings);
+    WsConnection::Stats connectionStats() const;
+
+    // opens the session and starts the event dispatcher
     void run();
+    // closes the session and waits for it, ioc keeps running for whatever else is on it
     void stop();
 
 private:
-    void doSend(const std::string &payload);
-    asio::io_context &ioc;
+    // one encoded message, the buffer is reused for the life of the manager
+    struct Outgoing
+    {
+        std::array<char, OrderEncoder::MaxMessageSize> bytes;
+        std::size_t size = 0;
+        int64_t traceOrigin = 0;
+        // steady_clock ns when it joined the queue
+        int64_t queuedAt = 0;
+        // order a place or cancel-replace opens, InvalidOrderId for cancels and status queries
+        OrderId placing = InvalidOrderId;
+    };
+
+    // legs per strand hop, small enough that the handler fits asio's recycled handler memory
+    static constexpr std::size_t MaxBatch = 4;
+    struct Batch
+    {
+        std::array<std::pair<OrderId, OrderRequest>, MaxBatch> legs;
+        std::size_t count = 0;
+        int64_t traceOrigin = 0;
+    };
 
-    // help with concurrency (in order)/ thread safety
+    // a place, or a cancel-replace when next.replaces is set
+    void encodeOrder(const OrderScheduler::Pending &next);
+    void encodeCancel(OrderId id, SymbolId symbol, int64_t traceOrigin);
+    void encodeStatus(OrderId id, SymbolId symbol);
+    // moves whatever the rate limits allow from the scheduler to the outbox, strand only
+    void schedule();
+    // an order that never left, closed locally: CANCELED when replaced in the scheduler,
+    // REJECTED when there was no session to send it on
+    void closeUnsent(OrderId id, OrderStatus status);
+    void readRateLimits(const json &response);
+    // free slot behind the queued messages, filled in place and then handed to doSend
+    Outgoing &nextOutgoing();
+    void doSend();
+    void writeNext();
+    // symbol names are only looked up when building the wire message
+    const SymbolRegistry &registry;
+
+    // help with concurrency (in order)/ thread safety, the websocket runs on this strand too
     asio::strand<boost::asio::io_context::executor_type> strand;
+    // ring of messages waiting for the write in flight, only touched on the strand
+    std::vector<std::unique_ptr<Outgoing>> outbox;
+    std::size_t outboxHead = 0;
+    std::size_t outboxCount = 0;
+    // written on the strand, read by outboxStats()
+    std::atomic<std::size_t> depthGauge{0};
+    std::atomic<std::size_t> maxDepth{0};
+    std::atomic<uint64_t> written{0};
+    LatencyHistogram queueDelay;
+    OrderEncoder encoder;
+    // everything headed for the outbox passes through here first, strand only
+    OrderScheduler scheduler;
+    asio::steady_timer throttleTimer;
+    bool throttleArmed = false;
+    std::atomic<std::size_t> scheduledGauge{0};
 
     std::mutex mu;
-    // eliminates race conditions, unique id
-    std::atomic<uint64_t> nextId{1};
-
-    // id to order mapping
-    std::unordered_map<std::string, Order> orders;
-
-    // registered callback
-    OrderCallback callback;
-
-    // websocket
-    void doResolve();
-    void onResolve(beast::error_code ec, tcp::resolver::results_type results);
-    void onConnect(beast::error_code ec, tcp::endpoint);
-    void onSslHandShake(beast::error_code ec);
-    void onWsHandshake(beast::error_code ec);
-    void onRead(beast::error_code ec, std::size_t bytes_transferred);
-    ssl::context &ssl_ctx;
-    tcp::resolver resolver;
-    ws::stream<ssl::stream<tcp::socket>> ws;
-    beast::flat_buffer buffer;
-    std::string port;
-    std::string host;
-    std::thread thread;
+    // live orders by id, terminal ones are released after their last callback
+    OrderStore orders;
+
+    // published on the strand with mu released
+    OrderEventDispatcher events;
+
+    // websocket, reconnects on its own; everything below runs on the strand
+    void onOpen(bool reconnected);
+    void onFrame(const char *data, std::size_t size);
+    void onClose();
+    // after a reconnect: asks the exchange for every order whose state may have changed unseen
+    void resync();
+    WsConnection connection;
+    bool writeInFlight = false;
+    // places written whose response has not arrived yet, queried again if the session drops
+    std::vector<OrderId> awaitingAck;
     std::atomic<bool> running{false};
 };
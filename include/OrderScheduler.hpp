@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Order.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// decides when queued order traffic may leave under the exchange's rate limits
+//  - one fixed window per limit the exchange reports in rateLimits, aligned to epoch like binance,
+//    with the reported count taken over whenever it is ahead of the local one
+//  - cancels always go first, then order.status queries, then new orders; queries only count
+//    against the request weight windows
+//  - every message is charged its method's request weight, see the *Weight constants
+//  - a new order replaces any unsent order for the same symbol and side, the strategy only
+//    ever wants its latest price there
+//  - not synchronized, OrderManager drives it from the socket strand; orderHeadroom() is the
+//    one call meant for other threads
+class OrderScheduler
+{
+public:
+    enum class LimitType : uint8_t
+    {
+        Orders,
+        RequestWeight
+    };
+
+    struct Pending
+    {
+        OrderId id = InvalidOrderId;
+        OrderRequest request;
+        int64_t traceOrigin = 0;
+        // set for a cancel-replace, the resting order it takes over from
+        OrderId replaces = InvalidOrderId;
+    };
+
+    enum class Next
+    {
+        None,
+        Place,
+        Cancel,
+        Status,
+        Throttled
+    };
+
+    // REQUEST_WEIGHT per method on the spot websocket api
+    static constexpr int64_t PlaceWeight = 1;
+    static constexpr int64_t CancelReplaceWeight = 1;
+    static constexpr int64_t CancelWeight = 1;
+    static constexpr int64_t StatusWeight = 4;
+
+    OrderScheduler();
+
+    // one rateLimits entry, e.g. ORDERS / SECOND / 10 / limit 50 / count 7
+    void updateLimit(LimitType type, int64_t intervalMs, int64_t limit, int64_t count, int64_t nowMs);
+    // 429 / 418 answers, nothing leaves before untilMs
+    void pauseUntil(int64_t untilMs);
+
+    void queueCancel(OrderId id, SymbolId symbol, int64_t traceOrigin);
+    // id of the unsent order this one superseded, InvalidOrderId when there was none; an amend
+    // of the superseded order takes over the resting order it was going to replace, anything
+    // else leaves that resting order to an explicit cancel, since the superseded amend had
+    // already asked for it to go
+    OrderId queuePlace(const Pending &pending);
+    // order.status for a live order, comes back from next() as Status with id and request.symbol
+    void queueStatus(OrderId id, SymbolId symbol);
+    // drops unsent status queries, e.g. before a reconnect asks for every order again
+    void clearStatus() { queries.clear(); }
+
+    // takes the next message that may go out now and charges it to every window; a place with
+    // replaces set goes out as one cancel-replace, a cancel or status query comes back with only
+    // id and request.symbol set
+    Next next(int64_t nowMs, Pending &out);
+    // epoch ms at which a throttled queue can move again
+    int64_t resumeAt(int64_t nowMs) const;
+
+    // new orders the tightest ORDERS window still takes, SIZE_MAX before any limit is known;
+    // nowMs past the next window boundary sees the refilled value without waiting for the strand
+    std::size_t orderHeadroom(int64_t nowMs) const
+    {
+        if (nowMs >= refillAt.load(std::memory_order_acquire))
+            return refilled.load(std::memory_order_relaxed);
+        return headroom.load(std::memory_order_relaxed);
+    }
+    std::size_t queued() const { return places.size() + cancels.size() + queries.size(); }
+    uint64_t superseded() const { return supersededCount.load(std::memory_order_relaxed); }
+    uint64_t throttled() const { return throttledCount.load(std::memory_order_relaxed); }
+
+    // "SECOND" / "MINUTE" / "HOUR" / "DAY" times intervalNum, 0 when unknown
+    static int64_t intervalMs(std::string_view interval, int64_t intervalNum);
+
+private:
+    struct Window
+    {
+        LimitType type;
+        int64_t intervalMs;
+        int64_t limit;
+        int64_t used;
+        int64_t start;
+    };
+
+    void roll(Window &window, int64_t nowMs) const;
+    // place: counts against the ORDERS windows too; weight: charged to the REQUEST_WEIGHT windows
+    bool fits(int64_t nowMs, bool place, int64_t weight);
+    void charge(bool place, int64_t weight);
+    // what next() would send now: whether it is an order and its weight, false when nothing waits
+    bool peek(bool &place, int64_t &weight) const;
+    void publishHeadroom();
+
+    std::vector<Window> windows;
+    std::vector<Pending> cancels;
+    std::vector<Pending> places;
+    std::vector<Pending> queries;
+    int64_t pausedUntil = 0;
+
+    std::atomic<std::size_t> headroom;
+    std::atomic<std::size_t> refilled;
+    std::atomic<int64_t> refillAt;
+    std::atomic<uint64_t> supersededCount{0};
+    std::atomic<uint64_t> throttledCount{0};
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Order.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// live orders in fixed-size slabs, addressed by the OrderId itself
+//  - an id is generation << 32 | slot, so a lookup is one index plus a generation check
+//  - terminal orders hand their slot back, a recycled slot bumps its generation so late
+//    acks for the old order miss instead of landing on the new one
+//  - slabs are only added when the live set outgrows every slab so far, never freed
+//  - not synchronized, OrderManager guards it
+class OrderStore
+{
+public:
+    static constexpr std::size_t SlabSize = 4096;
+
+    explicit OrderStore(std::size_t initialCapacity = SlabSize);
+
+    // copies the order in and stamps order.id, the returned id is what goes on the wire
+    OrderId insert(const Order &order);
+    // nullptr for unknown, malformed or recycled ids
+    Order *find(OrderId id);
+    // frees the slot, the id stops resolving
+    void release(OrderId id);
+
+    // fn(Order &) for every live order, in slot order
+    template <typename Fn>
+    void forEach(Fn &&fn)
+    {
+        for (const auto &slab : slabs)
+        {
+            for (std::size_t i = 0; i < SlabSize; ++i)
+            {
+                if (slab[i].used)
+                    fn(slab[i].order);
+            }
+        }
+    }
+
+    std::size_t live() const { return liveCount; }
+    std::size_t capacity() const { return slabs.size() * SlabSize; }
+    // slab storage, the store's whole footprint apart from the free list
+    std::size_t bytesReserved() const { return slabs.size() * SlabSize * sizeof(Slot); }
+
+    // wire form of an id, "client_<id>", longest is 27 bytes
+    static constexpr std::size_t MaxWireIdSize = 32;
+    static std::size_t formatId(char *out, OrderId id);
+    // accepts a trailing "_<suffix>" (e.g. "_cancel"), InvalidOrderId when out of shape
+    static OrderId parseId(std::string_view wire, std::string_view *suffix = nullptr);
+
+private:
+    struct Slot
+    {
+        Order order;
+        uint32_t generation = 0;
+        bool used = false;
+    };
+
+    void addSlab();
+    Slot *slotOf(OrderId id);
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    // recycled and never used slots, popped from the back
+    std::vector<uint32_t> freeSlots;
+    std::size_t liveCount = 0;
+};
@@ -14,19 +14,24 @@
 class PairsMeanReversionStrategy : public Strategy
 {
 public:
-    PairsMeanReversionStrategy(OrderManager &om, RiskManager &rm, std::string symbolA, std::string symbolB, double beta, size_t window, double entryZ, double exitZ);
+    PairsMeanReversionStrategy(OrderManager &om, RiskManager &rm, SymbolId symbolA, SymbolId symbolB, double beta, size_t window, double entryZ, double exitZ);
+    // only mids are used, so best bid/ask is enough
+    BookDepth requiredDepth() const override { return BookDepth::TopOfBook; }
     void onMarketData(const MarketData::Update &upd) override;
-    // void onOrderUpdate(const Order& ord)override;
+    void onTopOfBook(const MarketData::TopOfBook &tob) override;
 
 private:
+    void onMid(SymbolId symbol, double mid);
     void generateSignals(double z, double priceA, double priceB);
-    void attemptTrade(const std::string &sym, OrderSide side, double qty, double price);
+    void attemptPair(const OrderRequest &legA, const OrderRequest &legB);
     OrderManager &om;
     RollingStats stats;
     RiskManager &rm;
 
-    std::string symbolA, symbolB;
+    SymbolId symbolA, symbolB;
     double beta; // hedge ratio
+    // leg sizes, 1 of A against beta of B
+    Fixed quantityA, quantityB;
     double entryZ, exitZ;
 
     double lastPriceA, lastPriceB;
@@ -1,26 +1,34 @@
 #pragma once
 
 #include "OrderManager.hpp"
+#include <SymbolRegistry.hpp>
 #include <mutex>
-#include <unordered_map>
+#include <vector>
 #include <string>
 
-class RiskManager
+class RiskManager : public OrderListener
 {
 public:
-    RiskManager(OrderManager &om, double maxPositionPerSymbol, double maxTotalNotional);
+    RiskManager(OrderManager &om, const SymbolRegistry &registry, Fixed maxPositionPerSymbol, Fixed maxTotalNotional);
     ~RiskManager() = default;
 
-    bool approve(const std::string &symbol, OrderSide side, double quantity, double price, std::string &reason);
+    bool approve(SymbolId symbol, OrderSide side, Fixed quantity, Fixed price, std::string &reason);
+    // all legs or none: their notional and per-symbol position changes are summed and checked
+    // together under one lock, so legs that each fit cannot jointly breach a limit
+    bool approve(const OrderRequest *legs, std::size_t n, std::string &reason);
+    // fills move positions and notional, subscribed inline so approve() sees them before the next signal
+    void onOrderUpdate(const Order &order) override;
 
 private:
-    void onOrderUpdate(const Order &order);
     OrderManager &om;
+    const SymbolRegistry &registry;
 
-    double maxPos;
-    double maxNotional;
+    Fixed maxPos;
+    Fixed maxNotional;
 
     std::mutex mu;
-    std::unordered_map<std::string, double> positions;
-    double notionalTraded;
+    // indexed by SymbolId
+    std::vector<Fixed> positions;
+    // quote currency, exact sum of every fill's price * quantity
+    Fixed notionalTraded;
 };
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <DepthDiffParser.hpp>
+#include <MarketData.hpp>
+#include <SymbolRegistry.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// one <sym>@trade SBE event, several trades of one symbol
+struct SbeTrade
+{
+    int64_t id = 0;
+    Fixed price;
+    Fixed quantity;
+    bool buyerMaker = false;
+};
+
+struct SbeTrades
+{
+    SymbolId symbol = InvalidSymbol;
+    int64_t eventTimeUs = 0;
+    std::vector<SbeTrade> trades;
+};
+
+// decoder for binance's SBE market data streams (stream-sbe.binance.com, schema 1 version 0)
+//  - one message per binary frame: an 8 byte header (blockLength, templateId, schemaId, version,
+//    all little-endian uint16), the fixed block, repeating groups, then the symbol as varString8
+//  - reads fields straight out of the receive buffer, nothing is copied or allocated beyond
+//    the level / trade vectors the caller keeps warm
+//  - fixed blocks and group entries are stepped by the blockLength on the wire, so fields a newer
+//    schema version appends are skipped rather than misread
+//  - prices and quantities are int64 mantissas with one int8 exponent per message; a value finer
+//    than Fixed's 1e-8 or out of its range fails the message
+class SbeParser
+{
+public:
+    static constexpr uint16_t SchemaId = 1;
+    static constexpr std::size_t HeaderSize = 8;
+
+    enum class TemplateId : uint16_t
+    {
+        // <sym>@trade
+        Trades = 10000,
+        // <sym>@bestBidAsk, the bookTicker counterpart
+        BestBidAsk = 10001,
+        // <sym>@depth20, a partial book snapshot
+        DepthSnapshot = 10002,
+        // <sym>@depth, a diff with first / last book update ids
+        DepthDiff = 10003
+    };
+
+    struct Header
+    {
+        uint16_t blockLength;
+        uint16_t templateId;
+        uint16_t schemaId;
+        uint16_t version;
+    };
+
+    // false when the frame is shorter than a header or from another schema
+    static bool readHeader(const char *data, std::size_t size, Header &out);
+
+    // every parse returns false on a truncated message, another template, a bad exponent or
+    // an unknown symbol; `out` is then unspecified
+    static bool parseBestBidAsk(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::TopOfBook &out);
+    // best MarketData::Depth levels per side, false if a side is empty
+    static bool parseDepthSnapshot(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::Update &out);
+    // spot diffs chain through firstUpdateId, prevUpdateId stays -1
+    static bool parseDepthDiff(const char *data, std::size_t size, const SymbolRegistry &registry, DepthDiff &out);
+    static bool parseTrades(const char *data, std::size_t size, const SymbolRegistry &registry, SbeTrades &out);
+};
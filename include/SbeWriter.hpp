@@ -0,0 +1,128 @@
+#pragma once
+
+#include <SbeParser.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// builds the SBE messages SbeParser reads, for exchange_sim and the benchmarks
+//  - same layout as binance's schema 1 version 0, little-endian
+//  - values go in as mantissas; the exponents are per message, e.g. -2 for 0.01 price ticks
+namespace SbeWriter
+{
+    struct Level
+    {
+        int64_t price;
+        int64_t quantity;
+    };
+
+    struct Trade
+    {
+        int64_t id;
+        int64_t price;
+        int64_t quantity;
+        bool buyerMaker;
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        void put(std::string &out, T value)
+        {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            out.append(bytes, sizeof(T));
+        }
+
+        inline void header(std::string &out, uint16_t blockLength, SbeParser::TemplateId id)
+        {
+            out.clear();
+            put<uint16_t>(out, blockLength);
+            put<uint16_t>(out, static_cast<uint16_t>(id));
+            put<uint16_t>(out, SbeParser::SchemaId);
+            put<uint16_t>(out, 0);
+        }
+
+        inline void levels(std::string &out, const Level *levels, uint16_t count)
+        {
+            put<uint16_t>(out, 16);
+            put<uint16_t>(out, count);
+            for (uint16_t i = 0; i < count; ++i)
+            {
+                put<int64_t>(out, levels[i].price);
+                put<int64_t>(out, levels[i].quantity);
+            }
+        }
+
+        inline void symbol(std::string &out, std::string_view name)
+        {
+            put<uint8_t>(out, static_cast<uint8_t>(name.size()));
+            out.append(name.data(), name.size());
+        }
+    }
+
+    inline void bestBidAsk(std::string &out, std::string_view symbol, int64_t eventTimeUs, int64_t updateId,
+                           int8_t priceExponent, int8_t qtyExponent, Level bid, Level ask)
+    {
+        detail::header(out, 50, SbeParser::TemplateId::BestBidAsk);
+        detail::put<int64_t>(out, eventTimeUs);
+        detail::put<int64_t>(out, updateId);
+        detail::put<int8_t>(out, priceExponent);
+        detail::put<int8_t>(out, qtyExponent);
+        detail::put<int64_t>(out, bid.price);
+        detail::put<int64_t>(out, bid.quantity);
+        detail::put<int64_t>(out, ask.price);
+        detail::put<int64_t>(out, ask.quantity);
+        detail::symbol(out, symbol);
+    }
+
+    inline void depthSnapshot(std::string &out, std::string_view symbol, int64_t eventTimeUs, int64_t updateId,
+                              int8_t priceExponent, int8_t qtyExponent, const Level *bids, uint16_t bidCount,
+                              const Level *asks, uint16_t askCount)
+    {
+        detail::header(out, 18, SbeParser::TemplateId::DepthSnapshot);
+        detail::put<int64_t>(out, eventTimeUs);
+        detail::put<int64_t>(out, updateId);
+        detail::put<int8_t>(out, priceExponent);
+        detail::put<int8_t>(out, qtyExponent);
+        detail::levels(out, bids, bidCount);
+        detail::levels(out, asks, askCount);
+        detail::symbol(out, symbol);
+    }
+
+    inline void depthDiff(std::string &out, std::string_view symbol, int64_t eventTimeUs, int64_t firstUpdateId,
+                          int64_t lastUpdateId, int8_t priceExponent, int8_t qtyExponent, const Level *bids,
+                          uint16_t bidCount, const Level *asks, uint16_t askCount)
+    {
+        detail::header(out, 26, SbeParser::TemplateId::DepthDiff);
+        detail::put<int64_t>(out, eventTimeUs);
+        detail::put<int64_t>(out, firstUpdateId);
+        detail::put<int64_t>(out, lastUpdateId);
+        detail::put<int8_t>(out, priceExponent);
+        detail::put<int8_t>(out, qtyExponent);
+        detail::levels(out, bids, bidCount);
+        detail::levels(out, asks, askCount);
+        detail::symbol(out, symbol);
+    }
+
+    inline void trades(std::string &out, std::string_view symbol, int64_t eventTimeUs, int64_t transactTimeUs,
+                       int8_t priceExponent, int8_t qtyExponent, const Trade *trades, uint32_t count)
+    {
+        detail::header(out, 18, SbeParser::TemplateId::Trades);
+        detail::put<int64_t>(out, eventTimeUs);
+        detail::put<int64_t>(out, transactTimeUs);
+        detail::put<int8_t>(out, priceExponent);
+        detail::put<int8_t>(out, qtyExponent);
+        detail::put<uint16_t>(out, 25);
+        detail::put<uint32_t>(out, count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            detail::put<int64_t>(out, trades[i].id);
+            detail::put<int64_t>(out, trades[i].price);
+            detail::put<int64_t>(out, trades[i].quantity);
+            detail::put<uint8_t>(out, trades[i].buyerMaker ? 1 : 0);
+        }
+        detail::symbol(out, symbol);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <boost/asio/ssl.hpp>
+#include <string>
+
+// where a full-depth snapshot comes from when a book (re)syncs
+class SnapshotSource
+{
+public:
+    virtual ~SnapshotSource() = default;
+    // raw /depth response body for an exchange symbol (e.g. BTCUSDT), false on failure
+    virtual bool fetch(const std::string &symbol, std::string &body) = 0;
+};
+
+// reads <dir>/<SYMBOL>.json, for replays and offline runs
+class FileSnapshotSource : public SnapshotSource
+{
+public:
+    explicit FileSnapshotSource(std::string dir);
+    bool fetch(const std::string &symbol, std::string &body) override;
+
+private:
+    std::string dir;
+};
+
+// blocking HTTPS GET <path>?symbol=<SYMBOL>&limit=<limit>
+//  - runs on the caller's thread; only used while a book is out of sync, when the feed
+//    has nothing useful to deliver anyway, and MarketData backs off between requests per symbol
+class RestSnapshotSource : public SnapshotSource
+{
+public:
+    RestSnapshotSource(boost::asio::ssl::context &ssl_ctx, std::string host, std::string port, std::string path, int limit = 1000);
+    bool fetch(const std::string &symbol, std::string &body) override;
+
+private:
+    boost::asio::ssl::context &ssl_ctx;
+    std::string host;
+    std::string port;
+    std::string path;
+    int limit;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// bounded lock-free single-producer/single-consumer ring
+//  - capacity is rounded up to a power of two, storage is allocated once
+//  - each side caches the other side's index, so the shared cache lines are only
+//    touched when the cached view says the ring looks full/empty
+template <typename T>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing holds plain copyable events");
+
+public:
+    explicit SpscRing(std::size_t capacity)
+    {
+        if (capacity < 2)
+        {
+            throw std::invalid_argument("ring capacity has to be at least 2");
+        }
+        std::size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // producer thread only, false when full
+    bool tryPush(const T &item)
+    {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail > mask)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail > mask)
+                return false;
+        }
+        slots[h & mask] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread only, false when empty
+    bool tryPop(T &out)
+    {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead)
+                return false;
+        }
+        out = slots[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate from any thread
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    std::vector<T> slots;
+    std::size_t mask;
+
+    alignas(64) std::atomic<uint64_t> head{0};
+    uint64_t cachedTail = 0;
+    alignas(64) std::atomic<uint64_t> tail{0};
+    uint64_t cachedHead = 0;
+};
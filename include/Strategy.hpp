@@ -4,11 +4,26 @@
 #include <OrderManager.hpp>
 
 //parent class for all strategies
-class Strategy{
+class Strategy : public OrderListener{
     public: 
+        // how much of the book a strategy looks at, lets the feed pick the cheapest stream
+        enum class BookDepth{
+            TopOfBook,
+            Levels
+        };
+
         virtual ~Strategy()=default;
+        virtual BookDepth requiredDepth() const { return BookDepth::Levels; }
         //called everytime we have a new market update
         virtual void onMarketData (const MarketData::Update& upd)=0;
-        //called on every order update(acknowlegde/fill)
-        // virtual void onOrderUpdate(const Order& ord)=0;
-};
\ No newline at end of file
+        //called on every bookTicker update, defaults to a one-level Update
+        virtual void onTopOfBook(const MarketData::TopOfBook& tob){
+            MarketData::Update upd;
+            upd.symbol=tob.symbol;
+            upd.bids.push_back(tob.bid);
+            upd.asks.push_back(tob.ask);
+            onMarketData(upd);
+        }
+        //called on every order update(acknowlegde/fill) once subscribed to OrderManager::orderEvents
+        void onOrderUpdate(const Order&) override {}
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <ConflationSlots.hpp>
+#include <LatencyTrace.hpp>
+#include <Log.hpp>
+#include <SpscRing.hpp>
+#include <ThreadUtil.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+struct PipelineStats
+{
+    uint64_t pushed;
+    uint64_t delivered;
+    // events dropped because the strategy thread fell a full ring behind
+    uint64_t overruns;
+    // conflating mode: events replaced by a newer one for the same symbol before delivery
+    uint64_t conflated;
+    // queued events, or symbols waiting when conflating
+    std::size_t depth;
+    std::size_t maxDepth;
+};
+
+// hands decoded market events from the feed thread to a dedicated strategy thread
+//  - the feed thread only pushes into an SpscRing and goes straight back to async_read
+//  - the strategy thread, optionally pinned, busy-polls the ring and runs the handler
+//  - a full ring drops the new event and counts an overrun, the feed thread never waits
+//  - each event travels with the LatencyTrace origin of the frame it came from
+//  - conflating mode swaps the ring for per-symbol latest-value slots, a lagging strategy
+//    then skips straight to the freshest state of each symbol instead of working a backlog
+template <typename Event>
+class StrategyPipeline
+{
+public:
+    struct Options
+    {
+        std::size_t capacity = 4096;
+        // cpu for the strategy thread, -1 leaves it unpinned
+        int core = -1;
+        ThreadUtil::Scheduling scheduling = ThreadUtil::Scheduling::Normal;
+        int priority = 0;
+        // deliver only the latest event per symbol, symbols sizes the slots
+        bool conflate = false;
+        std::size_t symbols = 0;
+    };
+
+    StrategyPipeline(std::function<void(const Event &)> handler, Options options)
+        : handler(std::move(handler)), options(options)
+    {
+        if (options.conflate)
+            slots = std::make_unique<ConflationSlots<Entry>>(options.symbols);
+        else
+            ring = std::make_unique<SpscRing<Entry>>(options.capacity);
+    }
+
+    ~StrategyPipeline()
+    {
+        stop();
+    }
+
+    StrategyPipeline(const StrategyPipeline &) = delete;
+    StrategyPipeline &operator=(const StrategyPipeline &) = delete;
+
+    void start()
+    {
+        if (running.exchange(true))
+            return;
+        thread = std::thread([this]
+                             { poll(); });
+        ThreadUtil::pin(thread, options.core);
+        if (options.scheduling != ThreadUtil::Scheduling::Normal)
+            ThreadUtil::setScheduling(thread, options.scheduling, options.priority);
+    }
+
+    // delivers whatever is already queued, then joins
+    void stop()
+    {
+        if (!running.exchange(false))
+            return;
+        if (thread.joinable())
+            thread.join();
+    }
+
+    // feed thread only
+    bool push(const Event &event)
+    {
+        const Entry entry{event, HFT_TRACE_ORIGIN()};
+        const bool queued = slots ? slots->publish(event.symbol, entry) : ring->tryPush(entry);
+        if (!queued)
+        {
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        pushed.fetch_add(1, std::memory_order_relaxed);
+        std::size_t depth = this->depth();
+        if (depth > maxDepth.load(std::memory_order_relaxed))
+            maxDepth.store(depth, std::memory_order_relaxed);
+        return true;
+    }
+
+    PipelineStats stats() const
+    {
+        return PipelineStats{pushed.load(std::memory_order_relaxed), delivered.load(std::memory_order_relaxed),
+                             overruns.load(std::memory_order_relaxed), slots ? slots->conflatedTotal() : 0,
+                             depth(), maxDepth.load(std::memory_order_relaxed)};
+    }
+
+    // per-symbol conflation count, always 0 outside conflating mode
+    uint64_t conflated(SymbolId symbol) const
+    {
+        return slots ? slots->conflated(symbol) : 0;
+    }
+
+private:
+    struct Entry
+    {
+        Event event;
+        int64_t origin;
+    };
+
+    std::size_t depth() const
+    {
+        return slots ? slots->pending() : ring->size();
+    }
+
+    void poll()
+    {
+        if (slots)
+        {
+            auto deliver = [this](const Entry &entry)
+            { dispatch(entry); };
+            while (running.load(std::memory_order_relaxed))
+            {
+                if (slots->drain(deliver) == 0)
+                    ThreadUtil::cpuRelax();
+            }
+            slots->drain(deliver);
+            return;
+        }
+
+        SpscRing<Entry> &queue = *ring;
+        Entry entry;
+        while (running.load(std::memory_order_relaxed))
+        {
+            if (!queue.tryPop(entry))
+            {
+                ThreadUtil::cpuRelax();
+                continue;
+            }
+            dispatch(entry);
+        }
+        while (queue.tryPop(entry))
+            dispatch(entry);
+    }
+
+    void dispatch(const Entry &entry)
+    {
+        HFT_TRACE_SET_ORIGIN(entry.origin);
+        try
+        {
+            handler(entry.event);
+        }
+        catch (const std::exception &e)
+        {
+            HFT_LOG_ERROR("strategy handler error: {}", e.what());
+        }
+        delivered.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::function<void(const Event &)> handler;
+    Options options;
+    std::unique_ptr<SpscRing<Entry>> ring;
+    std::unique_ptr<ConflationSlots<Entry>> slots;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<std::size_t> maxDepth{0};
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Fixed.hpp>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// dense id handed out per symbol, indexes per-symbol state across the engine
+using SymbolId = uint16_t;
+constexpr SymbolId InvalidSymbol = std::numeric_limits<SymbolId>::max();
+
+// exchange PRICE_FILTER / LOT_SIZE steps, order prices and quantities are rendered on this grid
+struct SymbolInfo
+{
+    Fixed tickSize = Fixed::fromUnits(1000000);
+    Fixed lotSize = Fixed::fromUnits(1000);
+    // decimals needed to print a multiple of the step, e.g. 0.01 -> 2
+    uint8_t priceDecimals = 2;
+    uint8_t quantityDecimals = 5;
+};
+
+// symbol names <-> dense ids, filled once at startup
+//  - ids run 0..size()-1 so per-symbol state can be a plain array
+//  - names are only needed at the wire boundary and in logs
+//  - add() is startup only, lookups are safe from any thread afterwards
+class SymbolRegistry
+{
+public:
+    // idempotent, names are stored upper case
+    SymbolId add(std::string_view name);
+    // case-insensitive, InvalidSymbol when unknown
+    SymbolId find(std::string_view name) const;
+
+    // exchange form, e.g. BTCUSDT
+    const std::string &name(SymbolId id) const;
+    // stream form, e.g. btcusdt
+    const std::string &streamName(SymbolId id) const;
+    std::size_t size() const;
+
+    // startup only like add(), throws std::invalid_argument on a non-positive step
+    void setFilters(SymbolId id, Fixed tickSize, Fixed lotSize);
+    const SymbolInfo &info(SymbolId id) const;
+
+private:
+    std::vector<std::string> names;
+    std::vector<std::string> streamNames;
+    std::vector<SymbolInfo> infos;
+};
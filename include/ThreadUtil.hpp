@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// thread placement helpers shared by every component that owns a thread
+namespace ThreadUtil
+{
+    // pins to one cpu, core < 0 leaves the thread where the scheduler puts it
+    bool pin(std::thread &thread, int core);
+    bool pinCurrent(int core);
+
+    enum class Scheduling
+    {
+        // SCHED_OTHER, the default time-sharing policy
+        Normal,
+        // SCHED_FIFO, runs until it blocks or yields
+        Fifo,
+        // SCHED_RR, FIFO with a time slice among equal priorities
+        RoundRobin
+    };
+
+    // realtime policies need CAP_SYS_NICE or an rtprio limit; on failure the thread keeps its policy
+    bool setScheduling(std::thread &thread, Scheduling policy, int priority);
+    bool setSchedulingCurrent(Scheduling policy, int priority);
+    // "normal", "fifo" or "rr", throws std::invalid_argument otherwise
+    Scheduling parseScheduling(const std::string &name);
+
+    // what a busy-polling loop does once it has found nothing for a while
+    enum class Idle
+    {
+        // keep spinning with a pause hint, never gives the core up
+        Pause,
+        // sched_yield, lets another runnable thread on the core in
+        Yield,
+        // sleep sleepMicros, for cores that are shared
+        Sleep
+    };
+
+    struct SpinPolicy
+    {
+        // poll without ever blocking in the kernel instead of waiting for a wakeup
+        bool enabled = false;
+        Idle idle = Idle::Pause;
+        // empty polls in a row before Yield / Sleep kick in
+        int idleSpins = 10000;
+        int sleepMicros = 50;
+    };
+
+    // "pause", "yield" or "sleep", throws std::invalid_argument otherwise
+    Idle parseIdle(const std::string &name);
+
+    // spin-wait hint, keeps a busy-polling core from starving its hyperthread sibling
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ssl = boost::asio::ssl;
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace ws = beast::websocket;
+using tcp = asio::ip::tcp;
+
+// websocket-over-TLS client session that stays up, shared by MarketData and OrderManager
+//  - socket options go on before connect, so buffer sizes count toward the window scale
+//  - any failure, at any stage, closes the stream and retries after a backoff that doubles
+//    from reconnectMinMs up to reconnectMaxMs, reset once a session opens
+//  - the TLS session of the previous connection is offered on the next handshake, a resumed
+//    handshake skips the certificate exchange
+//  - frames are handed out where they lie in the receive buffer; the buffer is reserved up front
+//    and regrown to twice the largest frame seen on every connect, so a steady session reads
+//    without reallocating
+//  - every callback runs on the executor passed in; owners resubscribe / resync from onOpen
+class WsConnection
+{
+public:
+    using Stream = ws::stream<ssl::stream<tcp::socket>>;
+    using Executor = asio::strand<asio::io_context::executor_type>;
+
+    struct Settings
+    {
+        // nagle off, frames and orders are small and latency bound
+        bool noDelay = true;
+        // SO_RCVBUF / SO_SNDBUF in bytes, 0 keeps the kernel default
+        int receiveBuffer = 0;
+        int sendBuffer = 0;
+        // SO_BUSY_POLL in microseconds, 0 leaves it off; values above net.core.busy_poll need CAP_NET_ADMIN
+        int busyPollMicros = 0;
+        int reconnectMinMs = 50;
+        int reconnectMaxMs = 5000;
+        // bytes reserved for the receive buffer before the first read
+        std::size_t frameBuffer = 64 * 1024;
+    };
+
+    // readable from any thread
+    struct Stats
+    {
+        // sessions opened, the first one included
+        uint64_t connects;
+        uint64_t disconnects;
+        // handshakes that resumed the previous TLS session
+        uint64_t resumedSessions;
+        // session lost -> next session open
+        uint64_t lastOutageNs;
+        uint64_t maxOutageNs;
+        uint64_t frames;
+        uint64_t frameBytes;
+        uint64_t largestFrame;
+        // reads that outgrew the receive buffer
+        uint64_t bufferGrowths;
+        // bytes moved between the socket read and the frame callback, i.e. a regrown buffer
+        // carrying the partial frame over; zero once the reservation fits the feed
+        uint64_t bytesCopied;
+    };
+
+    // name tags the log lines, e.g. "market data"
+    WsConnection(Executor executor, ssl::context &sslCtx, std::string host, std::string port, std::string name);
+    ~WsConnection();
+
+    WsConnection(const WsConnection &) = delete;
+    WsConnection &operator=(const WsConnection &) = delete;
+
+    // everything below is set before start()
+    void setSettings(const Settings &settings);
+    // extra field on the upgrade request, e.g. an api key
+    void addHeader(std::string field, std::string value);
+    // request target, asked again on every connect so a resubscribe picks up the current streams
+    void onTarget(std::function<std::string()> cb);
+    // reconnected is false for the first session
+    void onOpen(std::function<void(bool reconnected)> cb);
+    // the frame only lives for the call
+    void onFrame(std::function<void(const char *data, std::size_t size)> cb);
+    // the session is gone, called once per session before the reconnect is scheduled
+    void onClose(std::function<void()> cb);
+
+    void start();
+    // stops reconnecting, closes the session and then calls done on the executor; any thread
+    void stop(std::function<void()> done = {});
+    // stop() and wait for the close, false on timeout, e.g. when the executor is not running;
+    // never from the executor itself
+    bool stopAndWait(std::chrono::milliseconds timeout);
+
+    // executor only from here on
+    bool isOpen() const { return open; }
+    // bumped whenever a session ends, completions that carry an older value belong to a dead stream
+    uint64_t generation() const { return sessionGeneration; }
+    // shared so a write completion can keep its stream alive across a reconnect
+    const std::shared_ptr<Stream> &stream() const { return current; }
+    // closes the session, e.g. after a failed write, and reconnects
+    void fail(const char *what, beast::error_code ec);
+
+    Stats stats() const;
+
+private:
+    void connect();
+    void onResolve(uint64_t gen, beast::error_code ec, tcp::resolver::results_type results);
+    void connectTo(uint64_t gen, tcp::resolver::results_type::const_iterator it);
+    void onConnect(uint64_t gen, tcp::resolver::results_type::const_iterator it, beast::error_code ec);
+    void onTlsHandshake(uint64_t gen, beast::error_code ec);
+    void onWsHandshake(uint64_t gen, beast::error_code ec);
+    void doRead();
+    void onRead(uint64_t gen, beast::error_code ec);
+    void applySocketOptions(tcp::socket &socket);
+    void scheduleReconnect();
+    void keepTlsSession();
+
+    Executor executor;
+    ssl::context &sslCtx;
+    std::string host;
+    std::string port;
+    std::string name;
+    Settings settings;
+    std::vector<std::pair<std::string, std::string>> headers;
+
+    std::function<std::string()> targetCallback;
+    std::function<void(bool)> openCallback;
+    std::function<void(const char *, std::size_t)> frameCallback;
+    std::function<void()> closeCallback;
+
+    tcp::resolver resolver;
+    asio::steady_timer retryTimer;
+    tcp::resolver::results_type endpoints;
+    std::shared_ptr<Stream> current;
+    beast::flat_buffer buffer;
+    // buffer capacity when the pending read started, a change means the read regrew it
+    std::size_t readCapacity = 0;
+    // SSL_SESSION of the last session, offered on the next handshake
+    SSL_SESSION *tlsSession = nullptr;
+
+    std::atomic<bool> running{false};
+    bool open = false;
+    uint64_t sessionGeneration = 0;
+    int backoffMs = 0;
+    // steady ns the last session was lost, 0 while up or before the first connect
+    int64_t lostAt = 0;
+
+    std::atomic<uint64_t> connects{0};
+    std::atomic<uint64_t> disconnects{0};
+    std::atomic<uint64_t> resumedSessions{0};
+    std::atomic<uint64_t> lastOutageNs{0};
+    std::atomic<uint64_t> maxOutageNs{0};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> frameBytes{0};
+    std::atomic<uint64_t> largestFrame{0};
+    std::atomic<uint64_t> bufferGrowths{0};
+    std::atomic<uint64_t> bytesCopied{0};
+};
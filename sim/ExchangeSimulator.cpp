@@ -0,0 +1,914 @@
+#include "ExchangeSimulator.hpp"
+#include <JournalReplay.hpp>
+#include <SbeWriter.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <nlohmann/json.hpp>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace asio = boost::asio;
+namespace ssl = boost::asio::ssl;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+using tcp = asio::ip::tcp;
+
+namespace
+{
+    int64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    int64_t wallMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // throwaway P-256 key and a self-signed CA:TRUE cert for localhost / 127.0.0.1
+    void useSelfSignedCertificate(ssl::context &ctx, const std::string &certOut)
+    {
+        EVP_PKEY *pkey = nullptr;
+        EVP_PKEY_CTX *kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+        if (!kctx || EVP_PKEY_keygen_init(kctx) <= 0 ||
+            EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) <= 0 ||
+            EVP_PKEY_keygen(kctx, &pkey) <= 0)
+        {
+            EVP_PKEY_CTX_free(kctx);
+            throw std::runtime_error("key generation failed");
+        }
+        EVP_PKEY_CTX_free(kctx);
+
+        X509 *cert = X509_new();
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 30L * 24 * 3600);
+        X509_set_pubkey(cert, pkey);
+        X509_NAME *name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+
+        X509V3_CTX v3;
+        X509V3_set_ctx_nodb(&v3);
+        X509V3_set_ctx(&v3, cert, cert, nullptr, nullptr, 0);
+        const std::pair<int, const char *> extensions[] = {
+            {NID_basic_constraints, "critical,CA:TRUE"},
+            {NID_key_usage, "critical,digitalSignature,keyCertSign"},
+            {NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1"}};
+        for (const auto &e : extensions)
+        {
+            X509_EXTENSION *ext = X509V3_EXT_conf_nid(nullptr, &v3, e.first, const_cast<char *>(e.second));
+            if (ext)
+            {
+                X509_add_ext(cert, ext, -1);
+                X509_EXTENSION_free(ext);
+            }
+        }
+        X509_sign(cert, pkey, EVP_sha256());
+
+        SSL_CTX_use_certificate(ctx.native_handle(), cert);
+        SSL_CTX_use_PrivateKey(ctx.native_handle(), pkey);
+
+        if (!certOut.empty())
+        {
+            if (FILE *f = std::fopen(certOut.c_str(), "w"))
+            {
+                PEM_write_X509(f, cert);
+                std::fclose(f);
+            }
+            else
+            {
+                std::cerr << "cannot write certificate to " << certOut << "\n";
+            }
+        }
+        X509_free(cert);
+        EVP_PKEY_free(pkey);
+    }
+
+    class Session;
+
+    std::string upper(std::string s)
+    {
+        for (auto &c : s)
+        {
+            if (c >= 'a' && c <= 'z')
+                c = static_cast<char>(c - 'a' + 'A');
+        }
+        return s;
+    }
+}
+
+struct ExchangeSimulator::State
+{
+    Options options;
+    std::unique_ptr<JournalReplay> journal;
+    std::vector<std::string_view> journalFrames;
+
+    std::mt19937_64 rng{2024};
+    std::unordered_map<std::string, double> mids;
+    uint64_t nextUpdateId = 1000000;
+    uint64_t nextOrderId = 1;
+
+    // steady_clock ns of the most recent market data frame handed to the socket
+    int64_t lastFrameSentNs = 0;
+    std::vector<int64_t> tickToTradeNs;
+
+    uint64_t framesSent = 0;
+    uint64_t ordersPlaced = 0;
+    uint64_t ordersCanceled = 0;
+    uint64_t ordersReplaced = 0;
+    // client ids of unfilled orders, the only ones a cancel can hit
+    std::unordered_set<std::string> resting;
+    // last known result of every order by client id, for order.status
+    std::unordered_map<std::string, nlohmann::json> orders;
+
+    // every accepted connection, for --drop-every
+    std::vector<std::weak_ptr<Session>> sessions;
+    uint64_t drops = 0;
+    uint64_t tlsHandshakes = 0;
+    uint64_t tlsResumed = 0;
+
+    // epoch-aligned windows echoed back in rateLimits like the real api: new orders per 10s,
+    // request weight per minute
+    int64_t orderWindowStartMs = 0;
+    int orderWindowCount = 0;
+    int64_t weightWindowStartMs = 0;
+    int weightWindowCount = 0;
+    uint64_t ordersThrottled = 0;
+
+    // the book behind the SBE @depth diffs and the REST /depth snapshots, prices in 0.01 ticks and
+    // quantities in 0.001 lots; shared by every connection, so a symbol's diffs only chain while
+    // a single connection streams them
+    struct Book
+    {
+        std::map<int64_t, int64_t, std::greater<int64_t>> bids;
+        std::map<int64_t, int64_t> asks;
+        int64_t lastUpdateId = 0;
+    };
+    std::unordered_map<std::string, Book> books;
+    uint64_t snapshotsServed = 0;
+
+    double nextMid(const std::string &symbol)
+    {
+        auto it = mids.find(symbol);
+        if (it == mids.end())
+        {
+            double start = symbol == "BTCUSDT" ? 43000.0 : symbol == "ETHUSDT" ? 2300.0 : 100.0;
+            it = mids.emplace(symbol, start).first;
+        }
+        std::normal_distribution<double> step(0.0, 0.0002);
+        it->second *= 1.0 + step(rng);
+        return it->second;
+    }
+};
+
+namespace
+{
+    using State = ExchangeSimulator::State;
+
+    enum class StreamKind
+    {
+        Depth5,
+        BookTicker,
+        // binary SBE streams
+        SbeDepth20,
+        SbeDepthDiff,
+        SbeBestBidAsk,
+        Unsupported
+    };
+
+    struct Stream
+    {
+        std::string symbol;
+        StreamKind kind;
+    };
+
+    // levels a synthetic book keeps per side
+    constexpr int BookDepth = 20;
+
+    // moves one side to the BookDepth levels from `best` outward (step -1 for bids, +1 for asks):
+    // levels outside that range go, missing ones come in and about one in four of the rest change
+    // size; every change lands in `changes`, quantity 0 for a removal
+    template <typename Side>
+    void reshape(Side &side, int64_t best, int64_t step, std::mt19937_64 &rng, std::vector<SbeWriter::Level> &changes)
+    {
+        std::uniform_int_distribution<int64_t> qty(1, 5000);
+        std::uniform_int_distribution<int> touch(0, 3);
+        const int64_t far = best + step * (BookDepth - 1);
+        for (auto it = side.begin(); it != side.end();)
+        {
+            if ((it->first - best) * step < 0 || (it->first - far) * step > 0)
+            {
+                changes.push_back({it->first, 0});
+                it = side.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        for (int64_t l = 0; l < BookDepth; ++l)
+        {
+            const int64_t price = best + step * l;
+            auto it = side.find(price);
+            if (it == side.end() || touch(rng) == 0)
+            {
+                const int64_t q = qty(rng);
+                side[price] = q;
+                changes.push_back({price, q});
+            }
+        }
+    }
+
+    // "<mantissa / 10^decimals>" with exactly `decimals` digits, for the REST snapshot body
+    void appendDecimal(std::string &out, int64_t mantissa, int decimals)
+    {
+        int64_t scale = 1;
+        for (int i = 0; i < decimals; ++i)
+            scale *= 10;
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "\"%lld.%0*lld\"", static_cast<long long>(mantissa / scale), decimals,
+                      static_cast<long long>(mantissa % scale));
+        out += buf;
+    }
+
+    // query parameter value out of a request target, empty when absent
+    std::string queryValue(const std::string &target, const std::string &key)
+    {
+        std::size_t q = target.find('?');
+        while (q != std::string::npos)
+        {
+            const std::size_t start = q + 1;
+            if (target.compare(start, key.size() + 1, key + "=") == 0)
+            {
+                const std::size_t end = target.find('&', start);
+                return target.substr(start + key.size() + 1, end == std::string::npos ? std::string::npos : end - start - key.size() - 1);
+            }
+            q = target.find('&', start);
+        }
+        return std::string();
+    }
+
+    class Session : public std::enable_shared_from_this<Session>
+    {
+    public:
+        Session(tcp::socket socket, ssl::context &ctx, std::shared_ptr<State> state)
+            : ws(std::move(socket), ctx), timer(ws.get_executor()), state(std::move(state)) {}
+
+        // the connection just goes away, like a gateway restart or a lost route
+        void drop()
+        {
+            beast::get_lowest_layer(ws).close();
+        }
+
+        void start()
+        {
+            beast::get_lowest_layer(ws).expires_after(std::chrono::seconds(10));
+            ws.next_layer().async_handshake(ssl::stream_base::server,
+                                            [self = shared_from_this()](beast::error_code ec)
+                                            { self->onTlsHandshake(ec); });
+        }
+
+    private:
+        void onTlsHandshake(beast::error_code ec)
+        {
+            if (ec)
+                return fail("tls handshake", ec);
+            ++state->tlsHandshakes;
+            if (SSL_session_reused(ws.next_layer().native_handle()))
+                ++state->tlsResumed;
+            http::async_read(ws.next_layer(), buffer, request,
+                             [self = shared_from_this()](beast::error_code ec, std::size_t)
+                             { self->onUpgradeRequest(ec); });
+        }
+
+        void onUpgradeRequest(beast::error_code ec)
+        {
+            if (ec)
+                return fail("upgrade request", ec);
+            std::string target(request.target());
+            if (!websocket::is_upgrade(request))
+                return serveSnapshot(target);
+            if (target.rfind("/ws-api/v3", 0) == 0)
+            {
+                orderSession = true;
+            }
+            else if (!parseStreams(target))
+            {
+                std::cerr << "sim: unknown target " << target << "\n";
+                return;
+            }
+            beast::get_lowest_layer(ws).expires_never();
+            ws.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+            ws.async_accept(request, [self = shared_from_this()](beast::error_code ec)
+                            { self->onAccept(ec); });
+        }
+
+        // /stream?streams=a@x/b@y or /ws/a@x
+        bool parseStreams(const std::string &target)
+        {
+            std::string list;
+            if (target.rfind("/stream?streams=", 0) == 0)
+                list = target.substr(16);
+            else if (target.rfind("/ws/", 0) == 0)
+                list = target.substr(4);
+            else
+                return false;
+            std::size_t pos = 0;
+            while (pos <= list.size())
+            {
+                std::size_t slash = list.find('/', pos);
+                std::string name = list.substr(pos, slash == std::string::npos ? std::string::npos : slash - pos);
+                std::size_t at = name.find('@');
+                if (at != std::string::npos)
+                {
+                    std::string suffix = name.substr(at + 1);
+                    StreamKind kind = StreamKind::Unsupported;
+                    if (suffix.rfind("depth5", 0) == 0)
+                        kind = StreamKind::Depth5;
+                    else if (suffix == "bookTicker")
+                        kind = StreamKind::BookTicker;
+                    else if (suffix == "depth20")
+                        kind = StreamKind::SbeDepth20;
+                    else if (suffix == "depth")
+                        kind = StreamKind::SbeDepthDiff;
+                    else if (suffix == "bestBidAsk")
+                        kind = StreamKind::SbeBestBidAsk;
+                    if (kind == StreamKind::Unsupported && !state->journal)
+                        std::cerr << "sim: cannot synthesize " << name << ", only depth5, bookTicker, depth20, depth and bestBidAsk\n";
+                    streams.push_back({name, kind});
+                }
+                if (slash == std::string::npos)
+                    break;
+                pos = slash + 1;
+            }
+            return !streams.empty();
+        }
+
+        void onAccept(beast::error_code ec)
+        {
+            if (ec)
+                return fail("accept", ec);
+            doRead();
+            if (!orderSession)
+                scheduleFrame();
+        }
+
+        void doRead()
+        {
+            ws.async_read(buffer, [self = shared_from_this()](beast::error_code ec, std::size_t)
+                          { self->onRead(ec); });
+        }
+
+        void onRead(beast::error_code ec)
+        {
+            if (ec)
+            {
+                closed = true;
+                timer.cancel();
+                return;
+            }
+            if (orderSession)
+            {
+                // stamp before parsing, this is the wire arrival as far as the sim can tell
+                const int64_t arrivedNs = nowNs();
+                handleRequest(beast::buffers_to_string(buffer.data()), arrivedNs);
+            }
+            buffer.consume(buffer.size());
+            doRead();
+        }
+
+        void scheduleFrame()
+        {
+            timer.expires_after(std::chrono::microseconds(state->options.intervalUs));
+            timer.async_wait([self = shared_from_this()](beast::error_code ec)
+                             {
+                if (ec || self->closed)
+                    return;
+                self->sendFrame();
+                self->scheduleFrame(); });
+        }
+
+        void sendFrame()
+        {
+            // a slow reader just misses frames, like a conflating exchange gateway
+            if (!outbox.empty())
+                return;
+            std::string frame;
+            bool binary = false;
+            if (state->journal)
+            {
+                if (state->journalFrames.empty())
+                    return;
+                frame.assign(state->journalFrames[journalPos++ % state->journalFrames.size()]);
+                binary = state->journal->encoding() == MarketData::Encoding::Sbe;
+            }
+            else
+            {
+                const Stream &stream = streams[streamPos++ % streams.size()];
+                if (stream.kind == StreamKind::Unsupported)
+                    return;
+                binary = stream.kind == StreamKind::SbeDepth20 || stream.kind == StreamKind::SbeDepthDiff ||
+                         stream.kind == StreamKind::SbeBestBidAsk;
+                frame = binary ? synthesizeSbe(stream) : synthesize(stream);
+            }
+            enqueue(std::move(frame), true, binary);
+        }
+
+        std::string synthesize(const Stream &stream)
+        {
+            std::string symbol = upper(stream.symbol.substr(0, stream.symbol.find('@')));
+            double mid = state->nextMid(symbol);
+            const double tick = 0.01;
+            double bestBid = std::floor(mid / tick) * tick;
+            double bestAsk = bestBid + tick;
+            std::uniform_real_distribution<double> qty(0.001, 5.0);
+            char buf[1024];
+            int n = 0;
+            uint64_t updateId = state->nextUpdateId++;
+            if (stream.kind == StreamKind::BookTicker)
+            {
+                n = std::snprintf(buf, sizeof(buf),
+                                  "{\"stream\":\"%s\",\"data\":{\"e\":\"bookTicker\",\"u\":%llu,\"E\":%lld,\"T\":%lld,\"s\":\"%s\","
+                                  "\"b\":\"%.2f\",\"B\":\"%.3f\",\"a\":\"%.2f\",\"A\":\"%.3f\"}}",
+                                  stream.symbol.c_str(), static_cast<unsigned long long>(updateId),
+                                  static_cast<long long>(wallMs()), static_cast<long long>(wallMs()), symbol.c_str(),
+                                  bestBid, qty(state->rng), bestAsk, qty(state->rng));
+            }
+            else
+            {
+                n = std::snprintf(buf, sizeof(buf),
+                                  "{\"stream\":\"%s\",\"data\":{\"e\":\"depthUpdate\",\"E\":%lld,\"T\":%lld,\"s\":\"%s\",\"U\":%llu,\"u\":%llu,\"pu\":%llu,\"b\":[",
+                                  stream.symbol.c_str(), static_cast<long long>(wallMs()), static_cast<long long>(wallMs()), symbol.c_str(),
+                                  static_cast<unsigned long long>(updateId), static_cast<unsigned long long>(updateId),
+                                  static_cast<unsigned long long>(updateId - 1));
+                for (int side = 0; side < 2; ++side)
+                {
+                    for (int l = 0; l < 5; ++l)
+                    {
+                        double px = side == 0 ? bestBid - l * tick : bestAsk + l * tick;
+                        n += std::snprintf(buf + n, sizeof(buf) - n, "%s[\"%.2f\",\"%.3f\"]", l ? "," : "", px, qty(state->rng));
+                    }
+                    n += std::snprintf(buf + n, sizeof(buf) - n, side == 0 ? "],\"a\":[" : "]}}");
+                }
+            }
+            return std::string(buf, static_cast<std::size_t>(std::max(n, 0)));
+        }
+
+        // same book as synthesize(), prices in 0.01 ticks and quantities in 0.001 lots
+        std::string synthesizeSbe(const Stream &stream)
+        {
+            std::string symbol = upper(stream.symbol.substr(0, stream.symbol.find('@')));
+            if (stream.kind == StreamKind::SbeDepthDiff)
+                return synthesizeDiff(symbol);
+            const int64_t bestBid = static_cast<int64_t>(std::floor(state->nextMid(symbol) * 100.0));
+            std::uniform_int_distribution<int64_t> qty(1, 5000);
+            const int64_t updateId = static_cast<int64_t>(state->nextUpdateId++);
+            const int64_t eventTimeUs = wallMs() * 1000;
+            std::string frame;
+            if (stream.kind == StreamKind::SbeBestBidAsk)
+            {
+                SbeWriter::bestBidAsk(frame, symbol, eventTimeUs, updateId, -2, -3, {bestBid, qty(state->rng)},
+                                      {bestBid + 1, qty(state->rng)});
+                return frame;
+            }
+            SbeWriter::Level bids[20];
+            SbeWriter::Level asks[20];
+            for (int l = 0; l < 20; ++l)
+            {
+                bids[l] = {bestBid - l, qty(state->rng)};
+                asks[l] = {bestBid + 1 + l, qty(state->rng)};
+            }
+            SbeWriter::depthSnapshot(frame, symbol, eventTimeUs, updateId, -2, -3, bids, 20, asks, 20);
+            return frame;
+        }
+
+        // one step of the symbol's book as a diff chained on the previous one (U = last u + 1);
+        // a quarter of the steps touch only the bids and a quarter only the asks, the rest move
+        // the touch and reshape both sides
+        std::string synthesizeDiff(const std::string &symbol)
+        {
+            State::Book &book = state->books[symbol];
+            std::uniform_int_distribution<int> sides(0, 3);
+            const int which = book.bids.empty() ? 3 : sides(state->rng);
+            int64_t bestBid = book.bids.empty() ? 0 : book.bids.begin()->first;
+            if (which >= 2)
+                bestBid = static_cast<int64_t>(std::floor(state->nextMid(symbol) * 100.0));
+            bidChanges.clear();
+            askChanges.clear();
+            if (which != 1)
+                reshape(book.bids, bestBid, -1, state->rng, bidChanges);
+            if (which != 0)
+                reshape(book.asks, bestBid + 1, 1, state->rng, askChanges);
+
+            std::uniform_int_distribution<int64_t> span(0, 2);
+            const int64_t first = book.lastUpdateId == 0 ? static_cast<int64_t>(state->nextUpdateId) : book.lastUpdateId + 1;
+            book.lastUpdateId = first + span(state->rng);
+            std::string frame;
+            SbeWriter::depthDiff(frame, symbol, wallMs() * 1000, first, book.lastUpdateId, -2, -3, bidChanges.data(),
+                                 static_cast<uint16_t>(bidChanges.size()), askChanges.data(),
+                                 static_cast<uint16_t>(askChanges.size()));
+            return frame;
+        }
+
+        // GET .../depth?symbol=<SYMBOL>&limit=<n> against the book the diffs come from
+        void serveSnapshot(const std::string &target)
+        {
+            const std::string symbol = upper(queryValue(target, "symbol"));
+            const std::string path = target.substr(0, target.find('?'));
+            response = {};
+            response.version(request.version());
+            response.keep_alive(false);
+            response.set(http::field::content_type, "application/json");
+            auto book = state->books.find(symbol);
+            if (path.size() < 6 || path.compare(path.size() - 6, 6, "/depth") != 0 || book == state->books.end())
+            {
+                response.result(http::status::bad_request);
+                response.body() = "{\"code\":-1121,\"msg\":\"Invalid symbol.\"}";
+            }
+            else
+            {
+                const std::string limitText = queryValue(target, "limit");
+                const std::size_t limit = limitText.empty() ? 100 : static_cast<std::size_t>(std::max(1, std::atoi(limitText.c_str())));
+                std::string &body = response.body();
+                body = "{\"lastUpdateId\":" + std::to_string(book->second.lastUpdateId);
+                auto side = [&](const char *name, const auto &levels)
+                {
+                    body += name;
+                    std::size_t n = 0;
+                    for (auto it = levels.begin(); it != levels.end() && n < limit; ++it, ++n)
+                    {
+                        body += n ? ",[" : "[";
+                        appendDecimal(body, it->first, 2);
+                        body += ',';
+                        appendDecimal(body, it->second, 3);
+                        body += ']';
+                    }
+                    body += ']';
+                };
+                side(",\"bids\":[", book->second.bids);
+                side(",\"asks\":[", book->second.asks);
+                body += '}';
+                response.result(http::status::ok);
+                ++state->snapshotsServed;
+            }
+            response.prepare_payload();
+            http::async_write(ws.next_layer(), response, [self = shared_from_this()](beast::error_code ec, std::size_t)
+                              {
+                if (ec)
+                    return self->fail("snapshot write", ec);
+                self->ws.next_layer().async_shutdown([self](beast::error_code) {}); });
+        }
+
+        void handleRequest(const std::string &text, int64_t arrivedNs)
+        {
+            nlohmann::json response;
+            try
+            {
+                auto req = nlohmann::json::parse(text);
+                response["id"] = req.value("id", nlohmann::json());
+                const std::string method = req.value("method", "");
+                const auto params = req.value("params", nlohmann::json::object());
+
+                const bool newOrder = method == "order.place" || method == "order.cancelReplace";
+                if (newOrder && !countOrder())
+                {
+                    // binance answers a full order window with 429 / -1015 and still counts the attempt
+                    ++state->ordersThrottled;
+                    response["status"] = 429;
+                    response["error"] = {{"code", -1015}, {"msg", "Too many new orders; current limit is 50 orders per 10 SECOND."}};
+                    response["rateLimits"] = rateLimits();
+                }
+                else if (method == "order.place")
+                {
+                    if (state->lastFrameSentNs > 0)
+                        state->tickToTradeNs.push_back(arrivedNs - state->lastFrameSentNs);
+                    ++state->ordersPlaced;
+                    response["status"] = 200;
+                    response["result"] = place(params);
+                    response["rateLimits"] = rateLimits();
+                }
+                else if (method == "order.cancelReplace")
+                {
+                    if (state->lastFrameSentNs > 0)
+                        state->tickToTradeNs.push_back(arrivedNs - state->lastFrameSentNs);
+                    const std::string orig = params.value("cancelOrigClientOrderId", "");
+                    if (state->resting.erase(orig) == 0)
+                    {
+                        // STOP_ON_FAILURE: a failed cancel leaves the new order unattempted
+                        response["status"] = 400;
+                        response["error"] = {{"code", -2022},
+                                             {"msg", "Order cancel-replace failed."},
+                                             {"data", {{"cancelResult", "FAILURE"},
+                                                       {"newOrderResult", "NOT_ATTEMPTED"},
+                                                       {"cancelResponse", {{"code", -2011}, {"msg", "Unknown order sent."}}},
+                                                       {"newOrderResponse", nullptr}}}};
+                    }
+                    else
+                    {
+                        ++state->ordersReplaced;
+                        markCanceled(orig);
+                        response["status"] = 200;
+                        response["result"] = {{"cancelResult", "SUCCESS"},
+                                              {"newOrderResult", "SUCCESS"},
+                                              {"cancelResponse", {{"symbol", params.value("symbol", "")},
+                                                                  {"origClientOrderId", orig},
+                                                                  {"status", "CANCELED"}}},
+                                              {"newOrderResponse", place(params)}};
+                    }
+                    response["rateLimits"] = rateLimits();
+                }
+                else if (method == "order.cancel")
+                {
+                    countWeight();
+                    const std::string orig = params.value("origClientOrderId", "");
+                    if (state->resting.erase(orig) == 0)
+                    {
+                        response["status"] = 400;
+                        response["error"] = {{"code", -2011}, {"msg", "Unknown order sent."}};
+                    }
+                    else
+                    {
+                        ++state->ordersCanceled;
+                        markCanceled(orig);
+                        response["status"] = 200;
+                        response["result"] = {
+                            {"symbol", params.value("symbol", "")},
+                            {"origClientOrderId", orig},
+                            {"status", "CANCELED"}};
+                    }
+                    response["rateLimits"] = rateLimits();
+                }
+                else if (method == "order.status")
+                {
+                    countWeight();
+                    auto order = state->orders.find(params.value("origClientOrderId", ""));
+                    if (order == state->orders.end())
+                    {
+                        response["status"] = 400;
+                        response["error"] = {{"code", -2013}, {"msg", "Order does not exist."}};
+                    }
+                    else
+                    {
+                        response["status"] = 200;
+                        response["result"] = order->second;
+                    }
+                    response["rateLimits"] = rateLimits();
+                }
+                else
+                {
+                    response["status"] = 400;
+                    response["error"] = {{"code", -1020}, {"msg", "unsupported method " + method}};
+                }
+            }
+            catch (const std::exception &e)
+            {
+                response["status"] = 400;
+                response["error"] = {{"code", -1102}, {"msg", e.what()}};
+            }
+            enqueue(response.dump(), false);
+        }
+
+        // order.place result, a --fill run fills everything on arrival and nothing rests
+        nlohmann::json place(const nlohmann::json &params)
+        {
+            const std::string qty = params.value("quantity", "0");
+            const std::string clientId = params.value("newClientOrderId", "");
+            const bool filled = state->options.fill;
+            if (!filled)
+                state->resting.insert(clientId);
+            nlohmann::json result = {
+                {"symbol", params.value("symbol", "")},
+                {"orderId", state->nextOrderId++},
+                {"clientOrderId", clientId},
+                {"transactTime", wallMs()},
+                {"price", params.value("price", "0")},
+                {"origQty", qty},
+                {"executedQty", filled ? qty : std::string("0.00000000")},
+                {"status", filled ? "FILLED" : "NEW"},
+                {"timeInForce", params.value("timeInForce", "GTC")},
+                {"type", params.value("type", "LIMIT")},
+                {"side", params.value("side", "")}};
+            state->orders[clientId] = result;
+            return result;
+        }
+
+        void markCanceled(const std::string &clientId)
+        {
+            auto order = state->orders.find(clientId);
+            if (order != state->orders.end())
+                order->second["status"] = "CANCELED";
+        }
+
+        static constexpr int OrderLimit = 50;
+        static constexpr int WeightLimit = 6000;
+
+        void rollWindows()
+        {
+            int64_t ms = wallMs();
+            if (ms - ms % 10000 != state->orderWindowStartMs)
+            {
+                state->orderWindowStartMs = ms - ms % 10000;
+                state->orderWindowCount = 0;
+            }
+            if (ms - ms % 60000 != state->weightWindowStartMs)
+            {
+                state->weightWindowStartMs = ms - ms % 60000;
+                state->weightWindowCount = 0;
+            }
+        }
+
+        void countWeight()
+        {
+            rollWindows();
+            ++state->weightWindowCount;
+        }
+
+        // false once the order window is full
+        bool countOrder()
+        {
+            countWeight();
+            return ++state->orderWindowCount <= OrderLimit;
+        }
+
+        nlohmann::json rateLimits()
+        {
+            return nlohmann::json::array({{{"rateLimitType", "ORDERS"}, {"interval", "SECOND"}, {"intervalNum", 10}, {"limit", OrderLimit}, {"count", state->orderWindowCount}},
+                                          {{"rateLimitType", "REQUEST_WEIGHT"}, {"interval", "MINUTE"}, {"intervalNum", 1}, {"limit", WeightLimit}, {"count", state->weightWindowCount}}});
+        }
+
+        void enqueue(std::string message, bool marketData, bool binary = false)
+        {
+            outbox.push_back({std::move(message), marketData, binary});
+            if (outbox.size() == 1)
+                doWrite();
+        }
+
+        void doWrite()
+        {
+            if (outbox.front().marketData)
+            {
+                state->lastFrameSentNs = nowNs();
+                ++state->framesSent;
+            }
+            ws.binary(outbox.front().binary);
+            ws.async_write(asio::buffer(outbox.front().text),
+                           [self = shared_from_this()](beast::error_code ec, std::size_t)
+                           {
+                if (ec)
+                {
+                    self->closed = true;
+                    self->timer.cancel();
+                    return;
+                }
+                self->outbox.pop_front();
+                if (!self->outbox.empty())
+                    self->doWrite(); });
+        }
+
+        void fail(const char *what, beast::error_code ec)
+        {
+            if (ec != asio::error::operation_aborted && ec != websocket::error::closed)
+                std::cerr << "sim: " << what << ": " << ec.message() << "\n";
+        }
+
+        struct Outgoing
+        {
+            std::string text;
+            bool marketData;
+            bool binary;
+        };
+
+        websocket::stream<beast::ssl_stream<beast::tcp_stream>> ws;
+        asio::steady_timer timer;
+        std::shared_ptr<State> state;
+        beast::flat_buffer buffer;
+        http::request<http::string_body> request;
+        http::response<http::string_body> response;
+        bool orderSession = false;
+        bool closed = false;
+        std::vector<Stream> streams;
+        std::size_t streamPos = 0;
+        std::size_t journalPos = 0;
+        std::deque<Outgoing> outbox;
+        // diff levels, kept warm between frames
+        std::vector<SbeWriter::Level> bidChanges;
+        std::vector<SbeWriter::Level> askChanges;
+    };
+}
+
+ExchangeSimulator::ExchangeSimulator(asio::io_context &ioc, Options options)
+    : ioc(ioc), sslCtx(ssl::context::tlsv12_server), acceptor(ioc), dropTimer(ioc), state(std::make_shared<State>())
+{
+    state->options = std::move(options);
+    useSelfSignedCertificate(sslCtx, state->options.certOut);
+    if (!state->options.journal.empty())
+    {
+        state->journal = std::make_unique<JournalReplay>(state->options.journal);
+        state->journalFrames = state->journal->frames();
+    }
+    for (const auto &symbol : state->options.symbols)
+        state->nextMid(upper(symbol));
+}
+
+ExchangeSimulator::~ExchangeSimulator() = default;
+
+void ExchangeSimulator::start()
+{
+    tcp::endpoint endpoint(asio::ip::make_address(state->options.address), state->options.port);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(asio::socket_base::reuse_address(true));
+    acceptor.bind(endpoint);
+    acceptor.listen();
+    std::cout << "sim listening on " << endpoint << (state->journal ? " (journal replay)" : " (synthetic)") << std::endl;
+    doAccept();
+    if (state->options.dropEverySeconds > 0)
+        scheduleDrop();
+}
+
+void ExchangeSimulator::stop()
+{
+    beast::error_code ec;
+    acceptor.close(ec);
+    dropTimer.cancel();
+    ioc.stop();
+}
+
+void ExchangeSimulator::scheduleDrop()
+{
+    dropTimer.expires_after(std::chrono::seconds(state->options.dropEverySeconds));
+    dropTimer.async_wait([this](beast::error_code ec)
+                         {
+        if (ec)
+            return;
+        std::size_t dropped = 0;
+        for (const auto &weak : state->sessions)
+        {
+            if (auto session = weak.lock())
+            {
+                session->drop();
+                ++dropped;
+            }
+        }
+        state->sessions.clear();
+        state->drops += dropped;
+        std::cout << "sim: dropped " << dropped << " connections" << std::endl;
+        scheduleDrop(); });
+}
+
+void ExchangeSimulator::doAccept()
+{
+    acceptor.async_accept([this](beast::error_code ec, tcp::socket socket)
+                          {
+        if (ec)
+            return;
+        socket.set_option(tcp::no_delay(true));
+        auto session = std::make_shared<Session>(std::move(socket), sslCtx, state);
+        if (state->options.dropEverySeconds > 0)
+            state->sessions.push_back(session);
+        session->start();
+        doAccept(); });
+}
+
+void ExchangeSimulator::report(std::ostream &os) const
+{
+    os << "frames sent: " << state->framesSent << ", orders placed: " << state->ordersPlaced
+       << ", cancels: " << state->ordersCanceled << ", replaced: " << state->ordersReplaced
+       << ", throttled: " << state->ordersThrottled << "\n";
+    os << "tls handshakes: " << state->tlsHandshakes << ", resumed: " << state->tlsResumed
+       << ", connections dropped: " << state->drops << ", depth snapshots served: " << state->snapshotsServed << "\n";
+    std::vector<int64_t> samples = state->tickToTradeNs;
+    if (samples.empty())
+    {
+        os << "no tick-to-trade samples\n";
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p)
+    {
+        std::size_t i = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+        return static_cast<double>(samples[i]) / 1000.0;
+    };
+    os << "loopback tick-to-trade (last frame sent -> order received), " << samples.size() << " samples, us:\n"
+       << "  p50 " << pct(0.50) << "  p90 " << pct(0.90) << "  p99 " << pct(0.99)
+       << "  p99.9 " << pct(0.999) << "  max " << pct(1.0) << "\n";
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// local stand-in for the binance endpoints the engine talks to
+//  - one TLS listener, certificate is self-signed and generated at start
+//  - /stream?streams=... and /ws/<stream>: replays journal frames or synthesizes depth5 / bookTicker,
+//    or their binary SBE counterparts depth20 / bestBidAsk, plus SBE depth diffs
+//  - GET .../depth?symbol=&limit=: REST snapshot of the book the SBE diffs are built from
+//  - /ws-api/v3: acks order.place (filling at the limit price unless told not to), order.cancel and
+//    order.cancelReplace against the orders still resting, answers order.status for every order seen
+//  - can cut every connection periodically to exercise the engine's reconnect path
+//  - stamps every market data frame on the way out and every order on the way in; order arrival
+//    minus the last frame sent is reported as the loopback tick-to-trade distribution
+class ExchangeSimulator
+{
+public:
+    struct Options
+    {
+        std::string address = "127.0.0.1";
+        unsigned short port = 9443;
+        // PEM of the generated certificate, point the engine's caFile at it
+        std::string certOut;
+        // replay raw frames from a MarketDataJournal instead of synthesizing
+        std::string journal;
+        // synthetic prices start from these, anything else starts at 100
+        std::vector<std::string> symbols{"BTCUSDT", "ETHUSDT"};
+        // spacing between market data frames on each connection
+        int intervalUs = 1000;
+        // fill order.place immediately instead of only acking
+        bool fill = true;
+        // close every connection without a goodbye this often, 0 never
+        int dropEverySeconds = 0;
+    };
+
+    struct State;
+
+    ExchangeSimulator(boost::asio::io_context &ioc, Options options);
+    ~ExchangeSimulator();
+
+    void start();
+    void stop();
+    // order counts and the tick-to-trade percentiles
+    void report(std::ostream &os) const;
+
+private:
+    void doAccept();
+    void scheduleDrop();
+
+    boost::asio::io_context &ioc;
+    boost::asio::ssl::context sslCtx;
+    boost::asio::ip::tcp::acceptor acceptor;
+    boost::asio::steady_timer dropTimer;
+    std::shared_ptr<State> state;
+};
@@ -0,0 +1,87 @@
+#include <BookTickerParser.hpp>
+#include <JsonCursor.hpp>
+#include <string_view>
+
+namespace
+{
+    bool parseObject(JsonCursor &cur, const SymbolRegistry &registry, MarketData::TopOfBook &out, int &fields)
+    {
+        if (!cur.consume('{'))
+            return false;
+        if (cur.consume('}'))
+            return true;
+        do
+        {
+            std::string_view key;
+            if (!cur.readKey(key) || key.empty())
+                return false;
+            bool ok = true;
+            if (key.size() == 1)
+            {
+                switch (key[0])
+                {
+                case 'b':
+                    ok = cur.readQuotedDecimal(out.bid.price);
+                    ++fields;
+                    break;
+                case 'B':
+                    ok = cur.readQuotedDecimal(out.bid.quantity);
+                    ++fields;
+                    break;
+                case 'a':
+                    ok = cur.readQuotedDecimal(out.ask.price);
+                    ++fields;
+                    break;
+                case 'A':
+                    ok = cur.readQuotedDecimal(out.ask.quantity);
+                    ++fields;
+                    break;
+                case 'u':
+                    ok = cur.readInt(out.updateId);
+                    break;
+                case 's':
+                    if (out.symbol == InvalidSymbol)
+                    {
+                        std::string_view name;
+                        ok = cur.readString(name);
+                        out.symbol = registry.find(name);
+                    }
+                    else
+                    {
+                        ok = cur.skipValue();
+                    }
+                    break;
+                default:
+                    ok = cur.skipValue();
+                }
+            }
+            else if (key == "stream")
+            {
+                std::string_view name;
+                ok = cur.readString(name);
+                out.symbol = registry.find(name.substr(0, name.find('@')));
+            }
+            else if (key == "data")
+            {
+                ok = parseObject(cur, registry, out, fields);
+            }
+            else
+            {
+                ok = cur.skipValue();
+            }
+            if (!ok)
+                return false;
+        } while (cur.next('}'));
+        return cur.ok();
+    }
+}
+
+bool BookTickerParser::parse(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::TopOfBook &out)
+{
+    out.symbol = InvalidSymbol;
+    int fields = 0;
+    JsonCursor cur(data, data + size);
+    if (!parseObject(cur, registry, out, fields))
+        return false;
+    return out.symbol != InvalidSymbol && fields == 4;
+}
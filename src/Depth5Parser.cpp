@@ -0,0 +1,93 @@
+#include <Depth5Parser.hpp>
+#include <JsonCursor.hpp>
+#include <string_view>
+
+namespace
+{
+    // "btcusdt@depth5" -> id of BTCUSDT
+    SymbolId resolveSymbol(std::string_view name, const SymbolRegistry &registry)
+    {
+        auto at = name.find('@');
+        if (at != std::string_view::npos)
+            name = name.substr(0, at);
+        return registry.find(name);
+    }
+
+    // [["price","qty"],...], levels past MarketData::Depth are skipped
+    bool parseLevels(JsonCursor &cur, MarketData::Levels &side)
+    {
+        if (!cur.consume('['))
+            return false;
+        if (cur.consume(']'))
+            return true;
+        do
+        {
+            if (side.full())
+            {
+                if (!cur.skipValue())
+                    return false;
+                continue;
+            }
+            MarketData::Level level;
+            if (!cur.consume('[') || !cur.readQuotedDecimal(level.price) || !cur.consume(',') ||
+                !cur.readQuotedDecimal(level.quantity) || !cur.consume(']'))
+                return false;
+            side.push_back(level);
+        } while (cur.next(']'));
+        return cur.ok();
+    }
+
+    bool parseObject(JsonCursor &cur, const SymbolRegistry &registry, MarketData::Update &out, bool &haveSymbol)
+    {
+        if (!cur.consume('{'))
+            return false;
+        if (cur.consume('}'))
+            return true;
+        do
+        {
+            std::string_view key;
+            if (!cur.readKey(key))
+                return false;
+            if (key == "stream" || (key == "s" && !haveSymbol))
+            {
+                std::string_view name;
+                if (!cur.readString(name))
+                    return false;
+                out.symbol = resolveSymbol(name, registry);
+                haveSymbol = true;
+            }
+            else if (key == "data")
+            {
+                if (!parseObject(cur, registry, out, haveSymbol))
+                    return false;
+            }
+            else if (key == "b" || key == "bids")
+            {
+                if (!parseLevels(cur, out.bids))
+                    return false;
+            }
+            else if (key == "a" || key == "asks")
+            {
+                if (!parseLevels(cur, out.asks))
+                    return false;
+            }
+            else if (!cur.skipValue())
+            {
+                return false;
+            }
+        } while (cur.next('}'));
+        return cur.ok();
+    }
+}
+
+bool Depth5Parser::parse(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::Update &out)
+{
+    out.symbol = InvalidSymbol;
+    out.bids.clear();
+    out.asks.clear();
+    bool haveSymbol = false;
+    JsonCursor cur(data, data + size);
+    if (!parseObject(cur, registry, out, haveSymbol))
+        return false;
+    return out.symbol != InvalidSymbol && !out.bids.empty() && !out.asks.empty();
+}
@@ -0,0 +1,94 @@
+#include <DepthDiffParser.hpp>
+#include <JsonCursor.hpp>
+#include <string_view>
+
+namespace
+{
+    // [["price","qty"],...], every level kept
+    bool parseLevels(JsonCursor &cur, std::vector<PriceLevel> &side)
+    {
+        if (!cur.consume('['))
+            return false;
+        if (cur.consume(']'))
+            return true;
+        do
+        {
+            PriceLevel level;
+            if (!cur.consume('[') || !cur.readQuotedDecimal(level.price) || !cur.consume(',') ||
+                !cur.readQuotedDecimal(level.quantity) || !cur.consume(']'))
+                return false;
+            side.push_back(level);
+        } while (cur.next(']'));
+        return cur.ok();
+    }
+
+    bool parseObject(JsonCursor &cur, const SymbolRegistry *registry, DepthDiff &out)
+    {
+        if (!cur.consume('{'))
+            return false;
+        if (cur.consume('}'))
+            return true;
+        do
+        {
+            std::string_view key;
+            if (!cur.readKey(key))
+                return false;
+            bool ok = true;
+            if (registry && (key == "stream" || (key == "s" && out.symbol == InvalidSymbol)))
+            {
+                std::string_view name;
+                ok = cur.readString(name);
+                auto at = name.find('@');
+                out.symbol = registry->find(at == std::string_view::npos ? name : name.substr(0, at));
+            }
+            else if (key == "data")
+                ok = parseObject(cur, registry, out);
+            else if (key == "U")
+                ok = cur.readInt(out.firstUpdateId);
+            else if (key == "u" || key == "lastUpdateId")
+                ok = cur.readInt(out.lastUpdateId);
+            else if (key == "pu")
+                ok = cur.readInt(out.prevUpdateId);
+            else if (key == "b" || key == "bids")
+                ok = parseLevels(cur, out.bids);
+            else if (key == "a" || key == "asks")
+                ok = parseLevels(cur, out.asks);
+            else
+                ok = cur.skipValue();
+            if (!ok)
+                return false;
+        } while (cur.next('}'));
+        return cur.ok();
+    }
+
+    void reset(DepthDiff &out)
+    {
+        out.symbol = InvalidSymbol;
+        out.firstUpdateId = 0;
+        out.lastUpdateId = 0;
+        out.prevUpdateId = -1;
+        out.bids.clear();
+        out.asks.clear();
+    }
+}
+
+bool DepthDiffParser::parse(const char *data, std::size_t size, const SymbolRegistry &registry, DepthDiff &out)
+{
+    reset(out);
+    JsonCursor cur(data, data + size);
+    if (!parseObject(cur, &registry, out))
+        return false;
+    return out.symbol != InvalidSymbol && out.lastUpdateId >= out.firstUpdateId;
+}
+
+bool DepthDiffParser::parseSnapshot(const char *data, std::size_t size, DepthDiff &out)
+{
+    SymbolId symbol = out.symbol;
+    reset(out);
+    out.symbol = symbol;
+    JsonCursor cur(data, data + size);
+    if (!parseObject(cur, nullptr, out))
+        return false;
+    out.firstUpdateId = out.lastUpdateId;
+    return out.lastUpdateId > 0;
+}
@@ -0,0 +1,140 @@
+#include <EngineConfig.hpp>
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    void readEndpoint(const nlohmann::json &j, const char *key, EngineConfig::Endpoint &out)
+    {
+        if (!j.contains(key))
+            return;
+        const auto &e = j.at(key);
+        out.host = e.value("host", out.host);
+        out.port = e.value("port", out.port);
+    }
+
+    Fixed readStep(const nlohmann::json &j, const char *key)
+    {
+        const auto &v = j.at(key);
+        if (!v.is_string())
+            return Fixed::fromDouble(v.get<double>());
+        const std::string &text = v.get_ref<const std::string &>();
+        Fixed step;
+        if (!Fixed::parse(text.data(), text.data() + text.size(), step))
+            throw std::runtime_error(std::string(key) + " is not a decimal: " + text);
+        return step;
+    }
+
+    void readPlacement(const nlohmann::json &j, const char *key, EngineConfig::ThreadPlacement &out)
+    {
+        if (!j.contains(key))
+            return;
+        const auto &t = j.at(key);
+        out.core = t.value("core", out.core);
+        if (t.contains("scheduling"))
+            out.scheduling = ThreadUtil::parseScheduling(t.at("scheduling").get<std::string>());
+        out.priority = t.value("priority", out.priority);
+        out.spin.enabled = t.value("spin", out.spin.enabled);
+        if (t.contains("idle"))
+            out.spin.idle = ThreadUtil::parseIdle(t.at("idle").get<std::string>());
+        out.spin.idleSpins = t.value("idleSpins", out.spin.idleSpins);
+        out.spin.sleepMicros = t.value("sleepMicros", out.spin.sleepMicros);
+        if (out.spin.idleSpins < 0 || out.spin.sleepMicros < 0)
+            throw std::invalid_argument(std::string("threads.") + key + ": idleSpins and sleepMicros must not be negative");
+    }
+}
+
+EngineConfig EngineConfig::load(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error("cannot open config " + path);
+    }
+
+    EngineConfig config;
+    try
+    {
+        nlohmann::json j = nlohmann::json::parse(in);
+        readEndpoint(j, "marketData", config.marketData);
+        readEndpoint(j, "orders", config.orders);
+        readEndpoint(j, "snapshotRest", config.snapshotRest);
+        config.symbols = j.value("symbols", config.symbols);
+        if (j.contains("filters"))
+        {
+            for (const auto &[name, f] : j.at("filters").items())
+                config.filters[name] = Filters{readStep(f, "tickSize"), readStep(f, "lotSize")};
+        }
+        config.feed = j.value("feed", config.feed);
+        config.encoding = j.value("encoding", config.encoding);
+        config.apiKey = j.value("apiKey", config.apiKey);
+        config.snapshotDir = j.value("snapshotDir", config.snapshotDir);
+        config.snapshotPath = j.value("snapshotPath", config.snapshotPath);
+        config.caFile = j.value("caFile", config.caFile);
+        config.verifyPeer = j.value("verifyPeer", config.verifyPeer);
+        config.journal = j.value("journal", config.journal);
+        if (j.contains("log"))
+        {
+            const auto &l = j.at("log");
+            config.log.file = l.value("file", config.log.file);
+            config.log.console = l.value("console", config.log.console);
+        }
+        if (j.contains("connection"))
+        {
+            const auto &c = j.at("connection");
+            config.connection.noDelay = c.value("noDelay", config.connection.noDelay);
+            config.connection.receiveBuffer = c.value("receiveBuffer", config.connection.receiveBuffer);
+            config.connection.sendBuffer = c.value("sendBuffer", config.connection.sendBuffer);
+            config.connection.busyPollMicros = c.value("busyPollMicros", config.connection.busyPollMicros);
+            config.connection.reconnectMinMs = c.value("reconnectMinMs", config.connection.reconnectMinMs);
+            config.connection.reconnectMaxMs = c.value("reconnectMaxMs", config.connection.reconnectMaxMs);
+            config.connection.frameBuffer = c.value("frameBuffer", config.connection.frameBuffer);
+        }
+        if (j.contains("threads"))
+        {
+            const auto &t = j.at("threads");
+            const std::string mode = t.value("mode", std::string(config.threads.single ? "single" : "dedicated"));
+            if (mode != "single" && mode != "dedicated")
+                throw std::runtime_error("threads.mode must be single or dedicated, got " + mode);
+            config.threads.single = mode == "single";
+            readPlacement(t, "marketData", config.threads.marketData);
+            readPlacement(t, "orders", config.threads.orders);
+            readPlacement(t, "strategy", config.threads.strategy);
+        }
+        if (j.contains("pipeline"))
+        {
+            const auto &p = j.at("pipeline");
+            config.pipeline.enabled = p.value("enabled", config.pipeline.enabled);
+            config.pipeline.core = p.value("core", config.pipeline.core);
+            config.pipeline.capacity = p.value("capacity", config.pipeline.capacity);
+            config.pipeline.conflate = p.value("conflate", config.pipeline.conflate);
+        }
+        config.runSeconds = j.value("runSeconds", config.runSeconds);
+    }
+    catch (const nlohmann::json::exception &e)
+    {
+        throw std::runtime_error("bad config " + path + ": " + e.what());
+    }
+    catch (const std::invalid_argument &e)
+    {
+        throw std::runtime_error("bad config " + path + ": " + e.what());
+    }
+    if (config.connection.reconnectMinMs <= 0 || config.connection.reconnectMaxMs < config.connection.reconnectMinMs)
+    {
+        throw std::runtime_error("config " + path + ": connection needs 0 < reconnectMinMs <= reconnectMaxMs");
+    }
+    if (config.feed != "auto" && config.feed != "depth5" && config.feed != "diff" && config.feed != "bookTicker")
+    {
+        throw std::runtime_error("config " + path + ": feed must be auto, depth5, diff or bookTicker, got " + config.feed);
+    }
+    if (config.encoding != "json" && config.encoding != "sbe")
+    {
+        throw std::runtime_error("config " + path + ": encoding must be json or sbe, got " + config.encoding);
+    }
+    if (config.symbols.size() < 2)
+    {
+        throw std::runtime_error("config " + path + ": the pairs strategy needs two symbols");
+    }
+    return config;
+}
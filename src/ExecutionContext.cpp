@@ -0,0 +1,101 @@
+#include <ExecutionContext.hpp>
+#include <Log.hpp>
+#include <chrono>
+#include <pthread.h>
+
+ExecutionContext::ExecutionContext(Options options) : options(std::move(options)) {}
+
+ExecutionContext::~ExecutionContext()
+{
+    stop();
+}
+
+void ExecutionContext::start()
+{
+    if (active.exchange(true))
+        return;
+    ioc.restart();
+    work.emplace(ioc.get_executor());
+    thread = std::thread([this]
+                         {
+        // linux caps thread names at 15 characters
+        pthread_setname_np(pthread_self(), options.name.substr(0, 15).c_str());
+        ThreadUtil::pinCurrent(options.core);
+        if (options.scheduling != ThreadUtil::Scheduling::Normal)
+            ThreadUtil::setSchedulingCurrent(options.scheduling, options.priority);
+        HFT_LOG_INFO("{} context running, core {}, {} on {}", options.name, options.core,
+                     options.spin.enabled ? "spinning" : "blocking", backend());
+        if (options.spin.enabled)
+            spin();
+        else
+            ioc.run(); });
+}
+
+void ExecutionContext::stop()
+{
+    if (!active.exchange(false))
+        return;
+    work.reset();
+    ioc.stop();
+    if (thread.joinable())
+        thread.join();
+}
+
+const char *ExecutionContext::backend()
+{
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+    return "io_uring";
+#else
+    return "epoll";
+#endif
+}
+
+ExecutionContext::Stats ExecutionContext::stats() const
+{
+    return Stats{polls.load(std::memory_order_relaxed), idlePolls.load(std::memory_order_relaxed),
+                 handlers.load(std::memory_order_relaxed), backoffs.load(std::memory_order_relaxed)};
+}
+
+void ExecutionContext::spin()
+{
+    const ThreadUtil::SpinPolicy policy = options.spin;
+    // one writer, plain stores keep the atomics off the bus lock
+    uint64_t pollCount = polls.load(std::memory_order_relaxed);
+    uint64_t idleCount = idlePolls.load(std::memory_order_relaxed);
+    uint64_t handlerCount = handlers.load(std::memory_order_relaxed);
+    uint64_t backoffCount = backoffs.load(std::memory_order_relaxed);
+    int emptyStreak = 0;
+    // poll() runs the reactor with a zero timeout, so ready sockets are picked up without a wakeup;
+    // the work guard keeps it from stopping the context between sessions
+    while (!ioc.stopped())
+    {
+        const std::size_t ran = ioc.poll();
+        ++pollCount;
+        if (ran != 0)
+        {
+            handlerCount += ran;
+            emptyStreak = 0;
+        }
+        else
+        {
+            ++idleCount;
+            if (policy.idle == ThreadUtil::Idle::Pause || emptyStreak < policy.idleSpins)
+            {
+                ++emptyStreak;
+                ThreadUtil::cpuRelax();
+            }
+            else
+            {
+                ++backoffCount;
+                if (policy.idle == ThreadUtil::Idle::Yield)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds(policy.sleepMicros));
+            }
+        }
+        polls.store(pollCount, std::memory_order_relaxed);
+        idlePolls.store(idleCount, std::memory_order_relaxed);
+        handlers.store(handlerCount, std::memory_order_relaxed);
+        backoffs.store(backoffCount, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,44 @@
+#include <Fixed.hpp>
+#include <ostream>
+
+std::size_t Fixed::format(char *out, unsigned decimals) const
+{
+    if (decimals > Decimals)
+        decimals = Decimals;
+
+    char digits[24];
+    std::size_t n = 0;
+    uint64_t magnitude = units < 0 ? 0 - static_cast<uint64_t>(units) : static_cast<uint64_t>(units);
+    for (unsigned cut = Decimals - decimals; cut > 0; --cut)
+        magnitude /= 10;
+    do
+    {
+        digits[n++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    // at least one digit before the point
+    while (n <= decimals)
+        digits[n++] = '0';
+
+    char *p = out;
+    if (units < 0)
+        *p++ = '-';
+    while (n > decimals)
+        *p++ = digits[--n];
+    if (decimals > 0)
+    {
+        *p++ = '.';
+        while (n > 0)
+            *p++ = digits[--n];
+    }
+    return static_cast<std::size_t>(p - out);
+}
+
+std::ostream &operator<<(std::ostream &os, Fixed value)
+{
+    unsigned decimals = Fixed::Decimals;
+    for (int64_t u = value.units; decimals > 0 && u % 10 == 0; u /= 10)
+        --decimals;
+    char text[24];
+    return os.write(text, static_cast<std::streamsize>(value.format(text, decimals)));
+}
@@ -0,0 +1,165 @@
+#include <JournalReplay.hpp>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+using Journal = MarketDataJournal;
+
+JournalReplay::JournalReplay(const std::string &path)
+{
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot open journal " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Journal::FileHeader))
+    {
+        ::close(fd);
+        throw std::runtime_error("journal too short: " + path);
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+        ::close(fd);
+        throw std::runtime_error("cannot mmap journal " + path + ": " + std::strerror(errno));
+    }
+    base = static_cast<const char *>(mapped);
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    Journal::FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, Journal::Magic, sizeof(header.magic)) != 0 || header.version != Journal::Version)
+    {
+        ::munmap(mapped, size);
+        ::close(fd);
+        throw std::runtime_error("not a market data journal: " + path);
+    }
+
+    // one pass up front for the symbol table and the recorded feed
+    bool sawFrame = false;
+    Journal::RecordHeader rec;
+    for (std::size_t offset = header.headerSize; recordAt(offset, rec);
+         offset += sizeof(rec) + Journal::padded(rec.length))
+    {
+        if (rec.kind == Journal::RecordKind::Symbol)
+        {
+            if (symbolNames.size() <= rec.symbol)
+                symbolNames.resize(rec.symbol + 1u);
+            symbolNames[rec.symbol].assign(base + offset + sizeof(rec), rec.length);
+        }
+        else if (!sawFrame && rec.kind != Journal::RecordKind::Snapshot)
+        {
+            recordedFeed = static_cast<MarketData::Feed>(rec.feed & ~Journal::SbeFeed);
+            if (rec.feed & Journal::SbeFeed)
+                recordedEncoding = MarketData::Encoding::Sbe;
+            sawFrame = true;
+        }
+    }
+    cursor = header.headerSize;
+}
+
+JournalReplay::~JournalReplay()
+{
+    if (base)
+        ::munmap(const_cast<char *>(base), size);
+    if (fd >= 0)
+        ::close(fd);
+}
+
+bool JournalReplay::recordAt(std::size_t offset, Journal::RecordHeader &header) const
+{
+    if (offset + sizeof(header) > size)
+        return false;
+    std::memcpy(&header, base + offset, sizeof(header));
+    return offset + sizeof(header) + header.length <= size;
+}
+
+std::vector<std::string_view> JournalReplay::frames() const
+{
+    Journal::FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    std::vector<std::string_view> out;
+    Journal::RecordHeader rec;
+    for (std::size_t offset = header.headerSize; recordAt(offset, rec); offset += sizeof(rec) + Journal::padded(rec.length))
+    {
+        if (rec.kind == Journal::RecordKind::Frame)
+            out.emplace_back(base + offset + sizeof(rec), rec.length);
+    }
+    return out;
+}
+
+std::size_t JournalReplay::run(MarketData &md, Pacing pacing, double speed)
+{
+    Journal::FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    stopping = false;
+
+    std::size_t delivered = 0;
+    int64_t firstNs = -1;
+    const auto start = std::chrono::steady_clock::now();
+    MarketData::Update update;
+    MarketData::TopOfBook tob;
+    Journal::RecordHeader rec;
+
+    for (cursor = header.headerSize; !stopping && recordAt(cursor, rec);)
+    {
+        const char *payload = base + cursor + sizeof(rec);
+        // advance first so a snapshot fetch triggered by this frame searches after it
+        cursor += sizeof(rec) + Journal::padded(rec.length);
+
+        if (rec.kind == Journal::RecordKind::Symbol || rec.kind == Journal::RecordKind::Snapshot)
+            continue;
+
+        if (pacing == Pacing::Recorded)
+        {
+            if (firstNs < 0)
+                firstNs = rec.recvNs;
+            auto due = start + std::chrono::nanoseconds(static_cast<int64_t>((rec.recvNs - firstNs) / speed));
+            std::this_thread::sleep_until(due);
+        }
+
+        switch (rec.kind)
+        {
+        case Journal::RecordKind::Frame:
+            md.processFrame(payload, rec.length);
+            break;
+        case Journal::RecordKind::Update:
+            if (rec.length != sizeof(update))
+                continue;
+            std::memcpy(&update, payload, sizeof(update));
+            md.deliver(update);
+            break;
+        case Journal::RecordKind::TopOfBook:
+            if (rec.length != sizeof(tob))
+                continue;
+            std::memcpy(&tob, payload, sizeof(tob));
+            md.deliver(tob);
+            break;
+        default:
+            continue;
+        }
+        ++delivered;
+    }
+    return delivered;
+}
+
+bool JournalReplay::fetch(const std::string &symbol, std::string &body)
+{
+    Journal::RecordHeader rec;
+    for (std::size_t offset = cursor; recordAt(offset, rec); offset += sizeof(rec) + Journal::padded(rec.length))
+    {
+        if (rec.kind == Journal::RecordKind::Snapshot && rec.symbol < symbolNames.size() && symbolNames[rec.symbol] == symbol)
+        {
+            body.assign(base + offset + sizeof(rec), rec.length);
+            return true;
+        }
+    }
+    return false;
+}
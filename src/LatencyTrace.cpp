@@ -0,0 +1,162 @@
+#include <LatencyTrace.hpp>
+#include <LatencyHistogram.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HFT_TRACE_TSC 1
+#endif
+
+namespace
+{
+    constexpr std::size_t StageCount = static_cast<std::size_t>(LatencyTrace::Stage::Count);
+    using StageHistograms = std::array<LatencyHistogram, StageCount>;
+
+    // every thread that records gets its own set, kept after the thread exits for the final report
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<StageHistograms>> registry;
+
+    std::atomic<double> nanosPerTick{0.0};
+    thread_local int64_t threadOrigin = 0;
+
+    StageHistograms &local()
+    {
+        thread_local StageHistograms *mine = nullptr;
+        if (mine == nullptr)
+        {
+            auto owned = std::make_unique<StageHistograms>();
+            mine = owned.get();
+            std::lock_guard lock(registryMutex);
+            registry.push_back(std::move(owned));
+        }
+        return *mine;
+    }
+
+    int64_t steadyNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    double scale()
+    {
+        double s = nanosPerTick.load(std::memory_order_relaxed);
+        if (s == 0.0)
+        {
+            LatencyTrace::calibrate();
+            s = nanosPerTick.load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+}
+
+const char *LatencyTrace::stageName(Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::Parsed:
+        return "parsed";
+    case Stage::Signal:
+        return "signal";
+    case Stage::RiskApproved:
+        return "risk approved";
+    case Stage::Serialized:
+        return "serialized";
+    case Stage::WriteDone:
+        return "write done";
+    case Stage::Ack:
+        return "exchange ack";
+    default:
+        return "?";
+    }
+}
+
+int64_t LatencyTrace::now()
+{
+#ifdef HFT_TRACE_TSC
+    return static_cast<int64_t>(__rdtsc());
+#else
+    return steadyNanos();
+#endif
+}
+
+void LatencyTrace::calibrate()
+{
+#ifdef HFT_TRACE_TSC
+    // 20 ms against steady_clock puts the rate well inside histogram precision
+    const int64_t wallStart = steadyNanos();
+    const int64_t tickStart = now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const int64_t wallEnd = steadyNanos();
+    const int64_t tickEnd = now();
+    if (tickEnd > tickStart)
+        nanosPerTick.store(static_cast<double>(wallEnd - wallStart) / static_cast<double>(tickEnd - tickStart), std::memory_order_relaxed);
+    else
+        nanosPerTick.store(1.0, std::memory_order_relaxed);
+#else
+    nanosPerTick.store(1.0, std::memory_order_relaxed);
+#endif
+}
+
+int64_t LatencyTrace::origin()
+{
+    return threadOrigin;
+}
+
+void LatencyTrace::setOrigin(int64_t ticks)
+{
+    threadOrigin = ticks;
+}
+
+void LatencyTrace::record(Stage stage, int64_t origin)
+{
+    if (origin == 0)
+        return;
+    const int64_t elapsed = now() - origin;
+    const uint64_t nanos = elapsed > 0 ? static_cast<uint64_t>(static_cast<double>(elapsed) * scale()) : 0;
+    local()[static_cast<std::size_t>(stage)].record(nanos);
+}
+
+void LatencyTrace::report(std::ostream &os)
+{
+    auto merged = std::make_unique<StageHistograms>();
+    {
+        std::lock_guard lock(registryMutex);
+        for (const auto &set : registry)
+        {
+            for (std::size_t s = 0; s < StageCount; ++s)
+                merged->at(s).add(set->at(s));
+        }
+    }
+
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+    os << "tick-to-trade from frame received, us:\n";
+    os << std::fixed << std::setprecision(1);
+    for (std::size_t s = 0; s < StageCount; ++s)
+    {
+        const LatencyHistogram &h = merged->at(s);
+        os << "  " << std::left << std::setw(14) << stageName(static_cast<Stage>(s)) << std::right
+           << " n " << std::setw(8) << h.count();
+        if (h.count() != 0)
+        {
+            os << "  p50 " << h.percentile(0.50) / 1e3
+               << "  p90 " << h.percentile(0.90) / 1e3
+               << "  p99 " << h.percentile(0.99) / 1e3
+               << "  p99.9 " << h.percentile(0.999) / 1e3
+               << "  p99.99 " << h.percentile(0.9999) / 1e3
+               << "  max " << h.max() / 1e3;
+        }
+        os << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
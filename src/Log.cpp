@@ -0,0 +1,589 @@
+#include <Log.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using Log::detail::Buffer;
+
+    // rings outlive their threads, whatever a thread logged just before exiting still gets written
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    // indexed by site id - 1
+    std::vector<const Log::Site *> sites;
+    std::size_t bufferBytes = std::size_t(1) << 20;
+
+    // start/stop, never taken by a logging thread
+    std::mutex lifecycleMutex;
+
+    void copyOut(const Buffer &buffer, uint64_t at, void *dst, std::size_t n)
+    {
+        const std::size_t offset = at & buffer.mask;
+        const std::size_t first = std::min(n, buffer.capacity - offset);
+        std::memcpy(dst, buffer.data + offset, first);
+        if (first < n)
+            std::memcpy(static_cast<char *>(dst) + first, buffer.data, n - first);
+    }
+
+    // "HH:MM:SS.uuuuuu" in UTC, with the date in front when asked
+    void appendTime(std::string &out, int64_t ns, bool withDate)
+    {
+        const std::time_t seconds = static_cast<std::time_t>(ns / 1000000000);
+        std::tm tm{};
+        gmtime_r(&seconds, &tm);
+        char text[40];
+        int n;
+        if (withDate)
+            n = std::snprintf(text, sizeof(text), "%04d-%02d-%02d %02d:%02d:%02d.%06d", tm.tm_year + 1900, tm.tm_mon + 1,
+                              tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ns % 1000000000 / 1000));
+        else
+            n = std::snprintf(text, sizeof(text), "%02d:%02d:%02d.%06d", tm.tm_hour, tm.tm_min, tm.tm_sec,
+                              static_cast<int>(ns % 1000000000 / 1000));
+        out.append(text, static_cast<std::size_t>(n));
+    }
+
+    int64_t wallNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // maps record ticks to wall time; the rate is measured from start and sharpens as the
+    // baseline grows, the anchor moves every second so drift never builds up
+    class Clock
+    {
+    public:
+        Clock()
+        {
+            wallBase = wallNanos();
+            tickBase = Log::detail::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            refresh();
+        }
+
+        void refresh()
+        {
+            wallAnchor = wallNanos();
+            tickAnchor = Log::detail::now();
+            if (tickAnchor > tickBase)
+                nanosPerTick = static_cast<double>(wallAnchor - wallBase) / static_cast<double>(tickAnchor - tickBase);
+        }
+
+        int64_t toWall(int64_t ticks) const
+        {
+            return wallAnchor + static_cast<int64_t>(static_cast<double>(ticks - tickAnchor) * nanosPerTick);
+        }
+
+    private:
+        int64_t wallBase;
+        int64_t tickBase;
+        int64_t wallAnchor = 0;
+        int64_t tickAnchor = 0;
+        double nanosPerTick = 1.0;
+    };
+
+    bool writeAll(int fd, const char *data, std::size_t size)
+    {
+        while (size != 0)
+        {
+            ssize_t n = ::write(fd, data, size);
+            if (n <= 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    // background side: drains the rings, formats for the console, batches file writes
+    class Writer
+    {
+    public:
+        Writer(const Log::Options &options) : console(options.console)
+        {
+            if (options.path.empty())
+                return;
+            fd = ::open(options.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+                throw std::runtime_error("cannot open log " + options.path + ": " + std::strerror(errno));
+            Log::FileHeader header{};
+            std::memcpy(header.magic, Log::Magic, sizeof(Log::Magic));
+            header.version = Log::Version;
+            header.headerSize = sizeof(Log::FileHeader);
+            if (!writeAll(fd, reinterpret_cast<const char *>(&header), sizeof(header)))
+            {
+                ::close(fd);
+                throw std::runtime_error("cannot write log header to " + options.path);
+            }
+        }
+
+        ~Writer()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+
+        void run()
+        {
+            auto nextRefresh = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (running.load(std::memory_order_acquire))
+            {
+                if (!drain())
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                if (std::chrono::steady_clock::now() >= nextRefresh)
+                {
+                    clock.refresh();
+                    nextRefresh += std::chrono::seconds(1);
+                }
+            }
+        }
+
+        bool drain()
+        {
+            {
+                std::lock_guard lock(registryMutex);
+                rings.clear();
+                for (const auto &buffer : buffers)
+                    rings.push_back(buffer.get());
+            }
+            bool any = false;
+            for (Buffer *ring : rings)
+            {
+                uint64_t t = ring->tail.load(std::memory_order_relaxed);
+                const uint64_t h = ring->head.load(std::memory_order_acquire);
+                while (t < h)
+                {
+                    Log::RecordHeader record;
+                    copyOut(*ring, t, &record, sizeof(record));
+                    record.timeNs = clock.toWall(record.timeNs);
+                    payload.resize(record.length);
+                    copyOut(*ring, t + sizeof(record), payload.data(), record.length);
+                    emit(record);
+                    t += sizeof(record) + Log::padded(record.length);
+                }
+                if (h != ring->tail.load(std::memory_order_relaxed))
+                {
+                    ring->tail.store(h, std::memory_order_release);
+                    any = true;
+                }
+            }
+            flush();
+            return any;
+        }
+
+        std::atomic<bool> running{true};
+        std::thread thread;
+
+    private:
+        const Log::Site *lookup(uint32_t id)
+        {
+            if (id == 0)
+                return nullptr;
+            if (id > known.size())
+            {
+                std::lock_guard lock(registryMutex);
+                known = sites;
+            }
+            return id <= known.size() ? known[id - 1] : nullptr;
+        }
+
+        void emit(const Log::RecordHeader &record)
+        {
+            const Log::Site *site = lookup(record.site);
+            if (site == nullptr)
+                return;
+            if (console)
+            {
+                std::string &text = site->level >= Log::Level::Warn ? errText : outText;
+                appendTime(text, record.timeNs, false);
+                text += ' ';
+                text += Log::levelName(site->level);
+                text += ' ';
+                if (!Log::format(text, site->format, site->tags, payload.data(), payload.size()))
+                    text += " <malformed arguments>";
+                text += '\n';
+            }
+            if (fd >= 0)
+            {
+                if (record.site > defined.size())
+                    defined.resize(record.site, false);
+                if (!defined[record.site - 1])
+                {
+                    define(*site, record.site, record.timeNs);
+                    defined[record.site - 1] = true;
+                }
+                append(record, payload.data());
+            }
+        }
+
+        void define(const Log::Site &site, uint32_t id, int64_t timeNs)
+        {
+            std::string body;
+            Log::SiteHeader header{};
+            header.id = id;
+            header.line = static_cast<uint32_t>(site.line);
+            header.level = site.level;
+            body.append(reinterpret_cast<const char *>(&header), sizeof(header));
+            for (const char *text : {site.file, site.format, site.tags})
+                body.append(text, std::strlen(text) + 1);
+            append(Log::RecordHeader{timeNs, 0, static_cast<uint32_t>(body.size())}, body.data());
+        }
+
+        void append(const Log::RecordHeader &record, const char *data)
+        {
+            const char *header = reinterpret_cast<const char *>(&record);
+            file.insert(file.end(), header, header + sizeof(record));
+            file.insert(file.end(), data, data + record.length);
+            file.resize(file.size() + Log::padded(record.length) - record.length, '\0');
+        }
+
+        void flush()
+        {
+            if (!outText.empty())
+            {
+                std::fwrite(outText.data(), 1, outText.size(), stdout);
+                std::fflush(stdout);
+                outText.clear();
+            }
+            if (!errText.empty())
+            {
+                std::fwrite(errText.data(), 1, errText.size(), stderr);
+                errText.clear();
+            }
+            if (!file.empty())
+            {
+                if (!writeAll(fd, file.data(), file.size()))
+                    std::cerr << "log write error: " << std::strerror(errno) << "\n";
+                file.clear();
+            }
+        }
+
+        const bool console;
+        Clock clock;
+        int fd = -1;
+        std::vector<Buffer *> rings;
+        std::vector<const Log::Site *> known;
+        // sites whose definition is already in the file, by id - 1
+        std::vector<bool> defined;
+        std::vector<char> payload;
+        std::vector<char> file;
+        std::string outText;
+        std::string errText;
+    };
+
+    std::unique_ptr<Writer> writer;
+
+    // a process that returns from main without stop() still gets its last records out
+    struct StopAtExit
+    {
+        ~StopAtExit() { Log::stop(); }
+    } stopAtExit;
+
+    bool appendArgument(std::string &out, char tag, const char *args, std::size_t length, std::size_t &pos)
+    {
+        if (tag == 's')
+        {
+            uint32_t size;
+            if (length - pos < sizeof(size))
+                return false;
+            std::memcpy(&size, args + pos, sizeof(size));
+            pos += sizeof(size);
+            if (length - pos < size)
+                return false;
+            out.append(args + pos, size);
+            pos += size;
+            return true;
+        }
+
+        uint64_t raw;
+        if (length - pos < sizeof(raw))
+            return false;
+        std::memcpy(&raw, args + pos, sizeof(raw));
+        pos += sizeof(raw);
+        char text[32];
+        int n = 0;
+        switch (tag)
+        {
+        case 'i':
+            n = std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(static_cast<int64_t>(raw)));
+            break;
+        case 'u':
+            n = std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(raw));
+            break;
+        case 'c':
+            text[0] = static_cast<char>(raw);
+            n = 1;
+            break;
+        case 'd':
+        {
+            double value;
+            std::memcpy(&value, &raw, sizeof(value));
+            n = std::snprintf(text, sizeof(text), "%.10g", value);
+            break;
+        }
+        case 'f':
+        {
+            // same text as operator<<, trailing zeros trimmed
+            const Fixed value = Fixed::fromUnits(static_cast<int64_t>(raw));
+            unsigned decimals = Fixed::Decimals;
+            for (int64_t u = value.units; decimals > 0 && u % 10 == 0; u /= 10)
+                --decimals;
+            n = static_cast<int>(value.format(text, decimals));
+            break;
+        }
+        default:
+            return false;
+        }
+        out.append(text, static_cast<std::size_t>(n));
+        return true;
+    }
+}
+
+Log::detail::Buffer::Buffer(std::size_t bytes)
+{
+    capacity = 4096;
+    while (capacity < bytes)
+        capacity <<= 1;
+    mask = capacity - 1;
+    data = new char[capacity];
+    // fault the pages in now rather than on the first records
+    std::memset(data, 0, capacity);
+}
+
+Log::detail::Buffer::~Buffer()
+{
+    delete[] data;
+}
+
+uint32_t Log::detail::registerSite(Site &site, const char *tags)
+{
+    std::lock_guard lock(registryMutex);
+    uint32_t id = site.id.load(std::memory_order_relaxed);
+    if (id != 0)
+        return id;
+    site.tags = tags;
+    sites.push_back(&site);
+    id = static_cast<uint32_t>(sites.size());
+    site.id.store(id, std::memory_order_release);
+    return id;
+}
+
+Log::detail::Buffer *Log::detail::attach()
+{
+    std::lock_guard lock(registryMutex);
+    buffers.push_back(std::make_unique<Buffer>(bufferBytes));
+    localBuffer() = buffers.back().get();
+    return localBuffer();
+}
+
+const char *Log::levelName(Level level)
+{
+    switch (level)
+    {
+    case Level::Debug:
+        return "DEBUG";
+    case Level::Info:
+        return "INFO ";
+    case Level::Warn:
+        return "WARN ";
+    case Level::Error:
+        return "ERROR";
+    default:
+        return "?    ";
+    }
+}
+
+void Log::start(const Options &options)
+{
+    std::lock_guard lifecycle(lifecycleMutex);
+    if (writer)
+        return;
+    {
+        std::lock_guard lock(registryMutex);
+        bufferBytes = options.threadBufferBytes;
+    }
+    writer = std::make_unique<Writer>(options);
+    Writer *w = writer.get();
+    w->thread = std::thread([w]
+                            { w->run(); });
+    detail::active.store(true, std::memory_order_release);
+}
+
+void Log::stop()
+{
+    std::lock_guard lifecycle(lifecycleMutex);
+    if (!writer)
+        return;
+    detail::active.store(false, std::memory_order_release);
+    writer->running.store(false, std::memory_order_release);
+    if (writer->thread.joinable())
+        writer->thread.join();
+    writer->drain();
+    writer.reset();
+}
+
+uint64_t Log::dropped()
+{
+    std::lock_guard lock(registryMutex);
+    uint64_t total = 0;
+    for (const auto &buffer : buffers)
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool Log::format(std::string &out, const char *format, const char *tags, const char *args, std::size_t length)
+{
+    std::size_t pos = 0;
+    const char *tag = tags;
+    for (const char *p = format; *p != '\0'; ++p)
+    {
+        if (p[0] == '{' && p[1] == '}' && *tag != '\0')
+        {
+            if (!appendArgument(out, *tag++, args, length, pos))
+                return false;
+            ++p;
+            continue;
+        }
+        out += *p;
+    }
+    // more arguments than placeholders, keep them rather than lose them
+    for (; *tag != '\0'; ++tag)
+    {
+        out += ' ';
+        if (!appendArgument(out, *tag, args, length, pos))
+            return false;
+    }
+    return pos == length;
+}
+
+bool Log::decode(const std::string &path, std::ostream &os)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "cannot open log " << path << "\n";
+        return false;
+    }
+    const std::vector<char> bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    FileHeader header;
+    if (bytes.size() < sizeof(header))
+    {
+        std::cerr << path << " is too short for a log header\n";
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version)
+    {
+        std::cerr << path << " is not a version " << Version << " binary log\n";
+        return false;
+    }
+
+    struct Definition
+    {
+        Level level;
+        uint32_t line;
+        const char *file;
+        const char *format;
+        const char *tags;
+    };
+    std::unordered_map<uint32_t, Definition> definitions;
+    struct Entry
+    {
+        int64_t timeNs;
+        std::size_t offset;
+    };
+    std::vector<Entry> entries;
+
+    std::size_t pos = header.headerSize;
+    while (pos + sizeof(RecordHeader) <= bytes.size())
+    {
+        RecordHeader record;
+        std::memcpy(&record, bytes.data() + pos, sizeof(record));
+        const std::size_t body = pos + sizeof(record);
+        if (record.length > bytes.size() - body)
+        {
+            // the process died mid-write, everything before this is intact
+            std::cerr << "truncated record at offset " << pos << "\n";
+            break;
+        }
+        if (record.site == 0)
+        {
+            SiteHeader site;
+            if (record.length < sizeof(site))
+                return false;
+            std::memcpy(&site, bytes.data() + body, sizeof(site));
+            const char *text = bytes.data() + body + sizeof(site);
+            const char *end = bytes.data() + body + record.length;
+            const char *strings[3];
+            for (const char *&s : strings)
+            {
+                s = text;
+                text = static_cast<const char *>(std::memchr(text, '\0', static_cast<std::size_t>(end - text)));
+                if (text == nullptr)
+                    return false;
+                ++text;
+            }
+            definitions[site.id] = Definition{site.level, site.line, strings[0], strings[1], strings[2]};
+        }
+        else
+        {
+            entries.push_back(Entry{record.timeNs, pos});
+        }
+        pos = body + padded(record.length);
+    }
+
+    // rings drain one thread at a time, the timestamps give the real order
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+                     { return a.timeNs < b.timeNs; });
+
+    std::string line;
+    for (const Entry &entry : entries)
+    {
+        RecordHeader record;
+        std::memcpy(&record, bytes.data() + entry.offset, sizeof(record));
+        line.clear();
+        appendTime(line, record.timeNs, true);
+        auto it = definitions.find(record.site);
+        if (it == definitions.end())
+        {
+            line += " ?     <undefined site " + std::to_string(record.site) + ">";
+        }
+        else
+        {
+            const Definition &def = it->second;
+            line += ' ';
+            line += levelName(def.level);
+            line += ' ';
+            if (!format(line, def.format, def.tags, bytes.data() + entry.offset + sizeof(record), record.length))
+                line += " <malformed arguments>";
+            line += "  [";
+            const char *slash = std::strrchr(def.file, '/');
+            line += slash != nullptr ? slash + 1 : def.file;
+            line += ':';
+            line += std::to_string(def.line);
+            line += ']';
+        }
+        line += '\n';
+        os.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    return true;
+}
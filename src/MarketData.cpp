@@ -1,11 +1,26 @@
 #include <MarketData.hpp>
+#include <Depth5Parser.hpp>
+#include <BookTickerParser.hpp>
+#include <SbeParser.hpp>
+#include <MarketDataJournal.hpp>
+#include <LatencyTrace.hpp>
+#include <Log.hpp>
 #include <iostream>
 #include <algorithm>
 #include <exception>
 #include <string>
 
-MarketData::MarketData(asio::io_context &ioc, ssl::context &ssl_ctx, std::string host, std::string port, std::vector<std::string> &symbols) : ioc(ioc), ssl_ctx(ssl_ctx), resolver(asio::make_strand(ioc)), ws(asio::make_strand(ioc), ssl_ctx),
-                                                                                                                                              host(std::move(host)), port(std::move(port)), symbols(std::move(symbols)) {}
+MarketData::MarketData(asio::io_context &ioc, ssl::context &ssl_ctx, std::string host, std::string port, const SymbolRegistry &registry, std::vector<SymbolId> symbols)
+    : registry(registry), connection(asio::make_strand(ioc), ssl_ctx, std::move(host), std::move(port), "market data"),
+      symbols(std::move(symbols)), lastUpdateIds(registry.size(), 0), gapOpen(registry.size(), false)
+{
+    connection.onTarget([this]
+                        { return buildTarget(); });
+    connection.onOpen([this](bool reconnected)
+                      { onOpen(reconnected); });
+    connection.onFrame([this](const char *data, std::size_t size)
+                       { onFrame(data, size); });
+}
 
 void MarketData::run()
 {
@@ -14,10 +29,7 @@ void MarketData::run()
         return;
     }
     running = true;
-    thread = std::thread([this]
-                         {
-        this->doResolve();
-        ioc.run(); });
+    connection.start();
 }
 
 void MarketData::stop()
@@ -25,18 +37,17 @@ void MarketData::stop()
     if (!running)
         return;
     running = false;
-    beast::error_code ec;
-    ws.close(beast::websocket::close_code::normal, ec);
-    // stop ssl
-    ws.next_layer().shutdown(ec);
-    // shutdown tcp
-    ws.next_layer().next_layer().shutdown(tcp::socket::shutdown_both, ec);
+    connection.stopAndWait(std::chrono::seconds(2));
+}
 
-    ioc.stop();
-    if (thread.joinable())
-    {
-        thread.join();
-    }
+void MarketData::setConnectionSettings(const WsConnection::Settings &settings)
+{
+    connection.setSettings(settings);
+}
+
+FeedStats MarketData::feedStats() const
+{
+    return FeedStats{connection.stats(), missedUpdates.load(std::memory_order_relaxed)};
 }
 
 void MarketData::onUpdate(std::function<void(const Update &)> cb)
@@ -44,157 +55,410 @@ void MarketData::onUpdate(std::function<void(const Update &)> cb)
     updateCallback = std::move(cb);
 }
 
+void MarketData::onTopOfBook(std::function<void(const TopOfBook &)> cb)
+{
+    topOfBookCallback = std::move(cb);
+}
+
+void MarketData::record(MarketDataJournal *j, bool decoded)
+{
+    journal = j;
+    journalDecoded = decoded;
+}
+
+void MarketData::setFeed(Feed newFeed, SnapshotSource *source)
+{
+    feed = newFeed;
+    snapshots = source;
+    if (feed == Feed::DiffDepth)
+    {
+        books.resize(registry.size());
+        // diff events carry tens of levels, size the scratch buffers once up front
+        diff.bids.reserve(1024);
+        diff.asks.reserve(1024);
+        snapshot.bids.reserve(5000);
+        snapshot.asks.reserve(5000);
+    }
+}
+
+void MarketData::setEncoding(Encoding newEncoding, const std::string &apiKey)
+{
+    encoding = newEncoding;
+    if (!apiKey.empty())
+        connection.addHeader("X-MBX-APIKEY", apiKey);
+}
+
+uint8_t MarketData::journalFeed() const
+{
+    return static_cast<uint8_t>(feed) | (encoding == Encoding::Sbe ? MarketDataJournal::SbeFeed : 0);
+}
+
+const OrderBook &MarketData::book(SymbolId symbol) const
+{
+    return books.at(symbol).book;
+}
+
+uint64_t MarketData::resyncCount(SymbolId symbol) const
+{
+    return books.at(symbol).resyncs;
+}
+
 std::string MarketData::buildTarget() const
 {
+    const bool sbe = encoding == Encoding::Sbe;
+    std::string stream;
+    switch (feed)
+    {
+    case Feed::Depth5:
+        stream = sbe ? "@depth20" : "@depth" + std::to_string(Depth);
+        break;
+    case Feed::DiffDepth:
+        stream = sbe ? "@depth" : "@depth@100ms";
+        break;
+    case Feed::BookTicker:
+        stream = sbe ? "@bestBidAsk" : "@bookTicker";
+        break;
+    }
     if (symbols.empty())
     {
-        return "/ws/btcusdt@depth5";
+        return "/ws/btcusdt" + stream;
     }
     std::string target = "/stream?streams=";
     bool first = true;
-    for (const auto &symbol : symbols)
+    for (SymbolId symbol : symbols)
     {
         if (!first)
             target += "/";
-        std::string lowerSymbol = symbol;
-        std::transform(lowerSymbol.begin(), lowerSymbol.end(),
-                       lowerSymbol.begin(), ::tolower);
-
-        target += lowerSymbol + "@depth5";
+        target += registry.streamName(symbol) + stream;
         first = false;
     }
     return target;
 }
 
-void MarketData::doResolve()
+void MarketData::onOpen(bool reconnected)
 {
-    resolver.async_resolve(
-        host, port, beast::bind_front_handler(&MarketData::onResolve, this));
+    if (!reconnected)
+        return;
+    // diffs sent while we were away are gone, every book starts over from a fresh snapshot
+    for (BookState &state : books)
+    {
+        state.synced = false;
+        state.bridging = false;
+        state.book.clear();
+        state.pending.clear();
+    }
+    for (std::size_t i = 0; i < lastUpdateIds.size(); ++i)
+    {
+        if (lastUpdateIds[i] != 0 && !gapOpen[i])
+        {
+            gapOpen[i] = true;
+            ++gapsOpen;
+        }
+    }
 }
 
-void MarketData::onResolve(beast::error_code ec, tcp::resolver::results_type results)
+void MarketData::onFrame(const char *data, std::size_t size)
 {
-    if (ec)
+    if (!running)
     {
-        std::cerr << "resolve error " << ec.message() << "\n";
         return;
     }
-    // starts TCP connection
-    asio::async_connect(
-        ws.next_layer().next_layer(), results, beast::bind_front_handler(&MarketData::onConnect, this));
-}
+    HFT_TRACE_FRAME();
 
-void MarketData::onConnect(beast::error_code ec, tcp::endpoint)
-{
-    if (ec)
+    if (journal && !journalDecoded)
     {
-        std::cerr << "Connect error: " << ec.message() << "\n";
-        return;
+        journal->append(MarketDataJournal::RecordKind::Frame, journalFeed(), InvalidSymbol,
+                        MarketDataJournal::now(), data, size);
     }
-    // TLS handshake
-    ws.next_layer().async_handshake(
-        ssl::stream_base::client, beast::bind_front_handler(&MarketData::onSslHandShake, this));
+    processFrame(data, size);
 }
 
-void MarketData::onSslHandShake(beast::error_code ec)
+void MarketData::measureGap(SymbolId symbol, int64_t firstId)
 {
-    if (ec)
-    {
-        std::cerr << "ssl handshake error " << ec.message() << "\n";
+    if (!gapOpen[symbol])
         return;
+    gapOpen[symbol] = false;
+    --gapsOpen;
+    const int64_t last = lastUpdateIds[symbol];
+    if (firstId > last + 1)
+    {
+        const auto missed = static_cast<uint64_t>(firstId - last - 1);
+        missedUpdates.fetch_add(missed, std::memory_order_relaxed);
+        HFT_LOG_INFO("{}: {} book updates missed while disconnected", registry.name(symbol), missed);
     }
-    std::string hostHeader = host + ":" + port;
-    std::string target = buildTarget();
-    // websocket handshake
-    ws.async_handshake(hostHeader, target, beast::bind_front_handler(&MarketData::onWsHandshake, this));
 }
 
-void MarketData::onWsHandshake(beast::error_code ec)
+bool MarketData::decodeDepth5(const char *data, std::size_t size)
+{
+    if (encoding == Encoding::Sbe)
+        return SbeParser::parseDepthSnapshot(data, size, registry, update);
+    return Depth5Parser::parse(data, size, registry, update);
+}
+
+bool MarketData::decodeDiff(const char *data, std::size_t size)
 {
-    if (ec)
+    if (encoding == Encoding::Sbe)
+        return SbeParser::parseDepthDiff(data, size, registry, diff);
+    return DepthDiffParser::parse(data, size, registry, diff);
+}
+
+bool MarketData::decodeTopOfBook(const char *data, std::size_t size)
+{
+    if (encoding == Encoding::Sbe)
+        return SbeParser::parseBestBidAsk(data, size, registry, topOfBook);
+    return BookTickerParser::parse(data, size, registry, topOfBook);
+}
+
+void MarketData::processFrame(const char *data, std::size_t size)
+{
+    switch (feed)
     {
-        std::cerr << "ws handshake error " << ec.message() << "\n";
-        return;
+    case Feed::Depth5:
+        if (!decodeDepth5(data, size))
+        {
+            HFT_LOG_WARN("Parse error: malformed depth payload");
+            return;
+        }
+        HFT_TRACE_STAGE(Parsed);
+        deliver(update);
+        break;
+    case Feed::DiffDepth:
+        if (!decodeDiff(data, size) || diff.symbol >= books.size())
+        {
+            HFT_LOG_WARN("Parse error: malformed depth diff payload");
+            return;
+        }
+        HFT_TRACE_STAGE(Parsed);
+        if (gapsOpen != 0)
+            measureGap(diff.symbol, diff.firstUpdateId);
+        lastUpdateIds[diff.symbol] = diff.lastUpdateId;
+        handleDiff();
+        break;
+    case Feed::BookTicker:
+        if (!decodeTopOfBook(data, size))
+        {
+            HFT_LOG_WARN("Parse error: malformed bookTicker payload");
+            return;
+        }
+        HFT_TRACE_STAGE(Parsed);
+        deliver(topOfBook);
+        break;
     }
-    // after websocket handshake, start reading
-    ws.async_read(buffer, beast::bind_front_handler(&MarketData::onRead, this));
 }
 
-void MarketData::onRead(beast::error_code ec, std::size_t bytes_transferred)
+void MarketData::handleDiff()
 {
-    if (ec)
+    BookState &state = books[diff.symbol];
+    if (!state.synced)
     {
-        std::cerr << "Read error " << ec.message() << "\n";
-        return;
+        // binance procedure: buffer diffs, fetch a snapshot, replay what the snapshot missed
+        if (state.pending.size() >= 4096)
+        {
+            HFT_LOG_WARN("dropping {} buffered diffs for {}", state.pending.size(), registry.name(diff.symbol));
+            state.pending.clear();
+        }
+        state.pending.push_back(diff);
+        if (!syncBook(diff.symbol))
+            return;
     }
-    if (!running)
+    else
     {
-        return;
+        switch (checkSequence(state, diff))
+        {
+        case Sequence::Stale:
+            return;
+        case Sequence::Apply:
+            applyDiff(state, diff);
+            break;
+        case Sequence::Gap:
+            HFT_LOG_WARN("depth gap on {}: book at {}, diff covers {}-{}, resyncing", registry.name(diff.symbol),
+                         state.book.lastUpdateId, diff.firstUpdateId, diff.lastUpdateId);
+            // a book that held long enough starts over from the shortest wait
+            if (std::chrono::steady_clock::now() - state.syncedAt > std::chrono::milliseconds(SyncBackoffMaxMs))
+                state.syncBackoffMs = SyncBackoffMinMs;
+            ++state.resyncs;
+            state.synced = false;
+            state.book.clear();
+            state.pending.clear();
+            state.pending.push_back(diff);
+            if (!syncBook(diff.symbol))
+                return;
+            break;
+        }
     }
+    publishBook(diff.symbol);
+}
 
-    std::string payload = beast::buffers_to_string(buffer.data());
-    buffer.consume(buffer.size());
-
-    try
+bool MarketData::syncBook(SymbolId symbol)
+{
+    BookState &state = books[symbol];
+    if (!snapshots)
     {
-        auto parseJson = json::parse(payload);
-        auto stream = parseJson["stream"].get<std::string>();
-        auto data = parseJson["data"];
-        auto sym = stream.substr(0, stream.find('@'));
+        HFT_LOG_ERROR("no snapshot source, cannot sync {}", registry.name(symbol));
+        return false;
+    }
+    // at most one fetch per backoff window, diffs keep buffering in between
+    const auto now = std::chrono::steady_clock::now();
+    if (now < state.nextSync)
+        return false;
+    state.nextSync = now + std::chrono::milliseconds(state.syncBackoffMs);
+    state.syncBackoffMs = std::min(state.syncBackoffMs * 2, SyncBackoffMaxMs);
 
-        std::transform(sym.begin(), sym.end(), sym.begin(), ::toupper);
+    std::string body;
+    snapshot.symbol = symbol;
+    if (!snapshots->fetch(registry.name(symbol), body) || !DepthDiffParser::parseSnapshot(body.data(), body.size(), snapshot))
+    {
+        HFT_LOG_WARN("snapshot unavailable for {}", registry.name(symbol));
+        return false;
+    }
+    if (journal && !journalDecoded)
+    {
+        journal->append(MarketDataJournal::RecordKind::Snapshot, journalFeed(), symbol,
+                        MarketDataJournal::now(), body.data(), body.size());
+    }
+    // the snapshot predates everything buffered, keep buffering and retry on the next diff
+    if (snapshot.lastUpdateId + 1 < state.pending.front().firstUpdateId)
+    {
+        HFT_LOG_WARN("snapshot for {} at {} is older than buffered diffs, retrying", registry.name(symbol),
+                     snapshot.lastUpdateId);
+        return false;
+    }
 
-        Update update;
-        update.symbol = sym;
+    state.book.clear();
+    for (const auto &level : snapshot.bids)
+        state.book.updateBid(level.price, level.quantity);
+    for (const auto &level : snapshot.asks)
+        state.book.updateAsk(level.price, level.quantity);
+    state.book.lastUpdateId = snapshot.lastUpdateId;
+    state.bridging = true;
 
-        auto bids = data["b"];
-        for (int i = 0; i < std::min(5, (int)bids.size()); ++i)
+    for (const auto &pending : state.pending)
+    {
+        Sequence seq = checkSequence(state, pending);
+        if (seq == Sequence::Gap)
         {
-            auto bid = bids[i];
-            Level level;
-            level.price = std::stod(bid[0].get<std::string>());
-            level.quantity = std::stod(bid[1].get<std::string>());
-            update.bids.push_back(level);
+            HFT_LOG_WARN("buffered diffs do not line up with snapshot for {}", registry.name(symbol));
+            state.book.clear();
+            state.pending.clear();
+            return false;
         }
+        if (seq == Sequence::Apply)
+            applyDiff(state, pending);
+    }
+    state.pending.clear();
+    state.synced = true;
+    state.syncedAt = now;
+    HFT_LOG_INFO("book synced for {} at update {}", registry.name(symbol), state.book.lastUpdateId);
+    return true;
+}
 
-        auto asks = data["a"];
-        for (int i = 0; i < std::min(5, (int)asks.size()); ++i)
-        {
-            auto ask = asks[i];
-            Level level;
-            level.price = std::stod(ask[0].get<std::string>());
-            level.quantity = std::stod(ask[1].get<std::string>());
-            update.asks.push_back(level);
-        }
+MarketData::Sequence MarketData::checkSequence(const BookState &state, const DepthDiff &d) const
+{
+    const int64_t last = state.book.lastUpdateId;
+    // first diff after a snapshot must straddle it: futures take U <= lastUpdateId <= u, so a
+    // diff ending on the snapshot id still bridges, spot needs U <= lastUpdateId + 1 <= u
+    if (state.bridging && d.prevUpdateId >= 0)
+    {
+        if (d.lastUpdateId < last)
+            return Sequence::Stale;
+        return d.firstUpdateId <= last ? Sequence::Apply : Sequence::Gap;
+    }
+    if (d.lastUpdateId <= last)
+        return Sequence::Stale;
+    if (state.bridging)
+        return d.firstUpdateId <= last + 1 ? Sequence::Apply : Sequence::Gap;
+    // futures streams chain through pu, spot through U == previous u + 1
+    if (d.prevUpdateId >= 0)
+        return d.prevUpdateId == last ? Sequence::Apply : Sequence::Gap;
+    return d.firstUpdateId == last + 1 ? Sequence::Apply : Sequence::Gap;
+}
+
+void MarketData::applyDiff(BookState &state, const DepthDiff &d)
+{
+    for (const auto &level : d.bids)
+        state.book.updateBid(level.price, level.quantity);
+    for (const auto &level : d.asks)
+        state.book.updateAsk(level.price, level.quantity);
+    state.book.lastUpdateId = d.lastUpdateId;
+    state.bridging = false;
+}
+
+void MarketData::publishBook(SymbolId symbol)
+{
+    const OrderBook &book = books[symbol].book;
+    if (book.empty())
+        return;
+    update.symbol = symbol;
+    update.bids.clear();
+    update.asks.clear();
+    for (std::size_t i = 0; i < Depth && i < book.bidDepth(); ++i)
+        update.bids.push_back(book.bid(i));
+    for (std::size_t i = 0; i < Depth && i < book.askDepth(); ++i)
+        update.asks.push_back(book.ask(i));
+    deliver(update);
+}
 
+void MarketData::deliver(const Update &upd)
+{
+    if (journal && journalDecoded)
+    {
+        journal->append(MarketDataJournal::RecordKind::Update, journalFeed(), upd.symbol,
+                        MarketDataJournal::now(), &upd, sizeof(upd));
+    }
+    try
+    {
         if (updateCallback)
         {
-            updateCallback(update);
+            updateCallback(upd);
         }
         else
         {
-            std::cout << "\n=== " << sym << "\n";
+            std::cout << "\n=== " << registry.name(upd.symbol) << "\n";
 
             std::cout << "Bids\n";
-            for (const auto &bid : update.bids)
+            for (const auto &bid : upd.bids)
             {
                 std::cout << "Price: " << bid.price << " | Quantity: " << bid.quantity << "\n";
             }
 
             std::cout << "Asks\n";
-            for (const auto &ask : update.asks)
+            for (const auto &ask : upd.asks)
             {
                 std::cout << "Price: " << ask.price << " | Quantity: " << ask.quantity << "\n";
             }
 
-            std::cout << "Mid Price: " << update.midPrice() << "\n";
+            std::cout << "Mid Price: " << upd.midPrice() << "\n";
         }
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Parse/print error: " << e.what() << "\n";
+        HFT_LOG_ERROR("Update handler error: {}", e.what());
     }
+}
 
-    // continue reading after getting first batch
-    ws.async_read(buffer, beast::bind_front_handler(&MarketData::onRead, this));
-}
\ No newline at end of file
+void MarketData::deliver(const TopOfBook &tob)
+{
+    if (journal && journalDecoded)
+    {
+        journal->append(MarketDataJournal::RecordKind::TopOfBook, journalFeed(), tob.symbol,
+                        MarketDataJournal::now(), &tob, sizeof(tob));
+    }
+    try
+    {
+        if (topOfBookCallback)
+        {
+            topOfBookCallback(tob);
+        }
+        else
+        {
+            std::cout << "\n=== " << registry.name(tob.symbol) << "\n";
+            std::cout << "Bid: " << tob.bid.price << " | Quantity: " << tob.bid.quantity << "\n";
+            std::cout << "Ask: " << tob.ask.price << " | Quantity: " << tob.ask.quantity << "\n";
+            std::cout << "Mid Price: " << tob.midPrice() << "\n";
+        }
+    }
+    catch (const std::exception &e)
+    {
+        HFT_LOG_ERROR("Top of book handler error: {}", e.what());
+    }
+}
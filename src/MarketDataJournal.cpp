@@ -0,0 +1,146 @@
+#include <MarketDataJournal.hpp>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+constexpr char MarketDataJournal::Magic[8];
+
+MarketDataJournal::MarketDataJournal(const std::string &path, const SymbolRegistry &registry, std::size_t ringBytes)
+{
+    std::size_t capacity = 1 << 16;
+    while (capacity < ringBytes)
+        capacity <<= 1;
+    ring.resize(capacity);
+    mask = capacity - 1;
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot open journal " + path + ": " + std::strerror(errno));
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.headerSize = sizeof(FileHeader);
+    if (::write(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header)))
+    {
+        ::close(fd);
+        throw std::runtime_error("cannot write journal header to " + path);
+    }
+    written = sizeof(header);
+
+    // symbol table first, so a replay can rebuild the registry without any config
+    const int64_t ts = now();
+    for (std::size_t id = 0; id < registry.size(); ++id)
+    {
+        const std::string &name = registry.name(static_cast<SymbolId>(id));
+        append(RecordKind::Symbol, 0, static_cast<SymbolId>(id), ts, name.data(), name.size());
+    }
+
+    running = true;
+    writer = std::thread([this]
+                         { writerLoop(); });
+}
+
+MarketDataJournal::~MarketDataJournal()
+{
+    stop();
+}
+
+int64_t MarketDataJournal::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void MarketDataJournal::copyIn(uint64_t at, const void *src, std::size_t n)
+{
+    std::size_t offset = at & mask;
+    std::size_t first = std::min(n, ring.size() - offset);
+    std::memcpy(ring.data() + offset, src, first);
+    if (first < n)
+        std::memcpy(ring.data(), static_cast<const char *>(src) + first, n - first);
+}
+
+bool MarketDataJournal::append(RecordKind kind, uint8_t feed, SymbolId symbol, int64_t recvNs, const void *data, std::size_t length)
+{
+    const std::size_t total = sizeof(RecordHeader) + padded(length);
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    if (total > ring.size() - (h - tail.load(std::memory_order_acquire)))
+    {
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    RecordHeader rec{};
+    rec.recvNs = recvNs;
+    rec.length = static_cast<uint32_t>(length);
+    rec.kind = kind;
+    rec.feed = feed;
+    rec.symbol = symbol;
+    copyIn(h, &rec, sizeof(rec));
+    copyIn(h + sizeof(rec), data, length);
+    // padding bytes are whatever the ring held before, replay never reads them
+
+    head.store(h + total, std::memory_order_release);
+    return true;
+}
+
+bool MarketDataJournal::flush()
+{
+    const uint64_t t = tail.load(std::memory_order_relaxed);
+    const uint64_t h = head.load(std::memory_order_acquire);
+    if (h == t)
+        return false;
+
+    // one or two contiguous chunks, whole batch in as few syscalls as the ring allows
+    uint64_t pos = t;
+    while (pos < h)
+    {
+        std::size_t offset = pos & mask;
+        std::size_t chunk = std::min<std::size_t>(h - pos, ring.size() - offset);
+        ssize_t n = ::write(fd, ring.data() + offset, chunk);
+        if (n <= 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "journal write error: " << std::strerror(errno) << "\n";
+            // give the space back so the feed thread is not starved by a dead disk
+            break;
+        }
+        pos += static_cast<uint64_t>(n);
+        written.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+    }
+    tail.store(h, std::memory_order_release);
+    return true;
+}
+
+void MarketDataJournal::writerLoop()
+{
+    while (running.load(std::memory_order_acquire))
+    {
+        if (!flush())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    flush();
+}
+
+void MarketDataJournal::stop()
+{
+    if (running.exchange(false))
+    {
+        if (writer.joinable())
+            writer.join();
+    }
+    if (fd >= 0)
+    {
+        flush();
+        ::close(fd);
+        fd = -1;
+    }
+}
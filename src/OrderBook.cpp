@@ -0,0 +1,50 @@
+#include <OrderBook.hpp>
+#include <algorithm>
+
+namespace
+{
+    // side is sorted so that `before(a, b)` means a sits further from the touch than b
+    template <typename Before>
+    void applyLevel(std::vector<PriceLevel> &side, Fixed price, Fixed quantity, Before before)
+    {
+        auto it = std::lower_bound(side.begin(), side.end(), price,
+                                   [&](const PriceLevel &level, Fixed p)
+                                   { return before(level.price, p); });
+        bool exists = it != side.end() && it->price == price;
+        if (quantity.isZero())
+        {
+            if (exists)
+                side.erase(it);
+            return;
+        }
+        if (exists)
+            it->quantity = quantity;
+        else
+            side.insert(it, PriceLevel{price, quantity});
+    }
+}
+
+OrderBook::OrderBook(std::size_t reserveLevels)
+{
+    bids.reserve(reserveLevels);
+    asks.reserve(reserveLevels);
+}
+
+void OrderBook::clear()
+{
+    bids.clear();
+    asks.clear();
+    lastUpdateId = 0;
+}
+
+void OrderBook::updateBid(Fixed price, Fixed quantity)
+{
+    applyLevel(bids, price, quantity, [](Fixed a, Fixed b)
+               { return a < b; });
+}
+
+void OrderBook::updateAsk(Fixed price, Fixed quantity)
+{
+    applyLevel(asks, price, quantity, [](Fixed a, Fixed b)
+               { return a > b; });
+}
@@ -0,0 +1,142 @@
+#include <OrderEncoder.hpp>
+#include <cstring>
+
+namespace
+{
+    constexpr std::string_view PlaceHead = "{\"id\":\"";
+    constexpr std::string_view PlaceType = "\",\"type\":\"LIMIT\",\"timeInForce\":\"GTC\",\"quantity\":\"";
+    constexpr std::string_view PlacePrice = "\",\"price\":\"";
+    constexpr std::string_view PlaceClientId = "\",\"newClientOrderId\":\"";
+    constexpr std::string_view AmendSide = "\",\"side\":\"";
+    constexpr std::string_view Close = "\"}}";
+
+    // bounded writer, remembers an overflow instead of checking at every call site
+    struct Writer
+    {
+        char *pos;
+        char *end;
+        bool overflow = false;
+
+        void put(std::string_view s)
+        {
+            if (static_cast<std::size_t>(end - pos) < s.size())
+            {
+                overflow = true;
+                return;
+            }
+            std::memcpy(pos, s.data(), s.size());
+            pos += s.size();
+        }
+
+        void putFixed(Fixed value, unsigned decimals)
+        {
+            // int64 plus sign, point and a leading zero
+            if (end - pos < 24)
+            {
+                overflow = true;
+                return;
+            }
+            pos += value.format(pos, decimals);
+        }
+    };
+}
+
+OrderEncoder::OrderEncoder(const SymbolRegistry &registry)
+{
+    templates.reserve(registry.size());
+    for (std::size_t id = 0; id < registry.size(); ++id)
+    {
+        const std::string &name = registry.name(static_cast<SymbolId>(id));
+        const SymbolInfo &info = registry.info(static_cast<SymbolId>(id));
+
+        Template t;
+        t.placeSymbol = "\",\"method\":\"order.place\",\"params\":{\"symbol\":\"" + name + "\",\"side\":\"";
+        t.cancelSymbol = "_cancel\",\"method\":\"order.cancel\",\"params\":{\"symbol\":\"" + name + "\",\"origClientOrderId\":\"";
+        t.statusSymbol = "_status\",\"method\":\"order.status\",\"params\":{\"symbol\":\"" + name + "\",\"origClientOrderId\":\"";
+        t.amendSymbol = "_amend\",\"method\":\"order.cancelReplace\",\"params\":{\"symbol\":\"" + name +
+                        "\",\"cancelReplaceMode\":\"STOP_ON_FAILURE\",\"cancelOrigClientOrderId\":\"";
+        t.priceDecimals = info.priceDecimals;
+        t.quantityDecimals = info.quantityDecimals;
+        t.tickUnits = info.tickSize.units;
+        t.lotUnits = info.lotSize.units;
+        templates.push_back(std::move(t));
+    }
+}
+
+std::size_t OrderEncoder::encodePlace(char *out, std::size_t capacity, std::string_view clientId, SymbolId symbol,
+                                      OrderSide side, Fixed quantity, Fixed price) const
+{
+    return encodeNew(out, capacity, clientId, std::string_view(), symbol, side, quantity, price);
+}
+
+std::size_t OrderEncoder::encodeCancelReplace(char *out, std::size_t capacity, std::string_view clientId, std::string_view origClientId,
+                                              SymbolId symbol, OrderSide side, Fixed quantity, Fixed price) const
+{
+    if (origClientId.empty())
+        return 0;
+    return encodeNew(out, capacity, clientId, origClientId, symbol, side, quantity, price);
+}
+
+std::size_t OrderEncoder::encodeNew(char *out, std::size_t capacity, std::string_view clientId, std::string_view origClientId,
+                                    SymbolId symbol, OrderSide side, Fixed quantity, Fixed price) const
+{
+    if (symbol >= templates.size())
+        return 0;
+    const Template &t = templates[symbol];
+
+    // never send more than risk approved: quantities round down to the lot, and prices round
+    // to the tick away from the market (buys down, sells up) so the limit is never more aggressive
+    const int64_t lots = quantity.units / t.lotUnits;
+    const int64_t ticks = side == OrderSide::BUY ? price.units / t.tickUnits
+                                                 : (price.units + t.tickUnits - 1) / t.tickUnits;
+    if (lots <= 0 || ticks <= 0)
+        return 0;
+
+    Writer w{out, out + capacity};
+    w.put(PlaceHead);
+    w.put(clientId);
+    if (origClientId.empty())
+    {
+        w.put(t.placeSymbol);
+    }
+    else
+    {
+        w.put(t.amendSymbol);
+        w.put(origClientId);
+        w.put(AmendSide);
+    }
+    w.put(side == OrderSide::BUY ? std::string_view("BUY") : std::string_view("SELL"));
+    w.put(PlaceType);
+    w.putFixed(Fixed::fromUnits(lots * t.lotUnits), t.quantityDecimals);
+    w.put(PlacePrice);
+    w.putFixed(Fixed::fromUnits(ticks * t.tickUnits), t.priceDecimals);
+    w.put(PlaceClientId);
+    w.put(clientId);
+    w.put(Close);
+    return w.overflow ? 0 : static_cast<std::size_t>(w.pos - out);
+}
+
+std::size_t OrderEncoder::encodeCancel(char *out, std::size_t capacity, std::string_view clientId, SymbolId symbol) const
+{
+    if (symbol >= templates.size())
+        return 0;
+    return encodeById(out, capacity, clientId, templates[symbol].cancelSymbol);
+}
+
+std::size_t OrderEncoder::encodeStatus(char *out, std::size_t capacity, std::string_view clientId, SymbolId symbol) const
+{
+    if (symbol >= templates.size())
+        return 0;
+    return encodeById(out, capacity, clientId, templates[symbol].statusSymbol);
+}
+
+std::size_t OrderEncoder::encodeById(char *out, std::size_t capacity, std::string_view clientId, const std::string &methodSymbol) const
+{
+    Writer w{out, out + capacity};
+    w.put(PlaceHead);
+    w.put(clientId);
+    w.put(methodSymbol);
+    w.put(clientId);
+    w.put(Close);
+    return w.overflow ? 0 : static_cast<std::size_t>(w.pos - out);
+}
@@ -0,0 +1,106 @@
+#include <OrderEventDispatcher.hpp>
+#include <Log.hpp>
+#include <ThreadUtil.hpp>
+#include <chrono>
+#include <exception>
+
+OrderEventDispatcher::OrderEventDispatcher() : OrderEventDispatcher(Options{})
+{
+}
+
+OrderEventDispatcher::OrderEventDispatcher(Options options) : options(options), ring(options.asyncCapacity)
+{
+}
+
+OrderEventDispatcher::~OrderEventDispatcher()
+{
+    stop();
+}
+
+void OrderEventDispatcher::subscribe(OrderListener &listener)
+{
+    inlineListeners.push_back(&listener);
+}
+
+void OrderEventDispatcher::subscribeAsync(OrderListener &listener)
+{
+    asyncListeners.push_back(&listener);
+}
+
+void OrderEventDispatcher::start()
+{
+    if (asyncListeners.empty() || running.exchange(true))
+        return;
+    thread = std::thread([this]
+                         { poll(); });
+    ThreadUtil::pin(thread, options.core);
+}
+
+void OrderEventDispatcher::stop()
+{
+    if (!running.exchange(false))
+        return;
+    if (thread.joinable())
+        thread.join();
+}
+
+void OrderEventDispatcher::publish(const Order &order)
+{
+    for (OrderListener *listener : inlineListeners)
+    {
+        try
+        {
+            listener->onOrderUpdate(order);
+        }
+        catch (const std::exception &e)
+        {
+            HFT_LOG_ERROR("order listener error: {}", e.what());
+        }
+    }
+
+    if (asyncListeners.empty())
+        return;
+    // before start() or after stop() there is nobody to drain the ring
+    if (!running.load(std::memory_order_relaxed) || !ring.tryPush(order))
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OrderEventDispatcher::poll()
+{
+    // order updates arrive at ack rate, not tick rate, so an idle dispatcher sleeps instead of spinning
+    Order order;
+    unsigned idle = 0;
+    while (running.load(std::memory_order_relaxed))
+    {
+        if (ring.tryPop(order))
+        {
+            idle = 0;
+            deliverAsync(order);
+        }
+        else if (++idle < 64)
+        {
+            ThreadUtil::cpuRelax();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    while (ring.tryPop(order))
+        deliverAsync(order);
+}
+
+void OrderEventDispatcher::deliverAsync(const Order &order)
+{
+    for (OrderListener *listener : asyncListeners)
+    {
+        try
+        {
+            listener->onOrderUpdate(order);
+        }
+        catch (const std::exception &e)
+        {
+            HFT_LOG_ERROR("order listener error: {}", e.what());
+        }
+    }
+}
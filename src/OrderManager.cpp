@@ -1,25 +1,88 @@
 #include <OrderManager.hpp>
-#include <iostream>
+#include <LatencyTrace.hpp>
+#include <Log.hpp>
 #include <exception>
+#include <chrono>
 
-OrderManager::OrderManager(asio::io_context &ioc, ssl::context &ssl_ctx, std::string host, std::string port) 
-    : ioc(ioc), ssl_ctx(ssl_ctx), resolver(asio::make_strand(ioc)), ws(asio::make_strand(ioc), ssl_ctx), 
-      strand(ioc.get_executor()), host(std::move(host)), port(std::move(port)) {}
+namespace
+{
+    int64_t steadyNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // binance windows are aligned to wall-clock time
+    int64_t epochMillis()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // quoted decimal field, zero when absent
+    Fixed readDecimal(const json &result, const char *key)
+    {
+        Fixed value;
+        auto it = result.find(key);
+        if (it == result.end())
+            return value;
+        const std::string &text = it->get_ref<const std::string &>();
+        if (!Fixed::parse(text.data(), text.data() + text.size(), value))
+            throw std::invalid_argument(std::string(key) + " is not a decimal: " + text);
+        return value;
+    }
+
+    // filled quantity, price and outcome of a ws-api order result
+    void readResult(const json &result, Fixed &fillQty, Fixed &fillPrice, bool &success)
+    {
+        fillQty = readDecimal(result, "executedQty");
+        fillPrice = readDecimal(result, "price");
+        success = result.value("status", "") != "REJECTED";
+    }
+}
+
+OrderManager::OrderManager(asio::io_context &ioc, ssl::context &ssl_ctx, std::string host, std::string port, const SymbolRegistry &registry) 
+    : registry(registry), strand(asio::make_strand(ioc)), encoder(registry), throttleTimer(strand),
+      connection(strand, ssl_ctx, std::move(host), std::move(port), "order entry")
+{
+    outbox.resize(64);
+    for (auto &slot : outbox)
+        slot = std::make_unique<Outgoing>();
+
+    connection.onTarget([]
+                        { return std::string("/ws-api/v3"); });
+    connection.onOpen([this](bool reconnected)
+                      { onOpen(reconnected); });
+    connection.onFrame([this](const char *data, std::size_t size)
+                       { onFrame(data, size); });
+    connection.onClose([this]
+                       { onClose(); });
+}
 
 OrderManager::~OrderManager() 
 {
     stop();
 }
 
+void OrderManager::setConnectionSettings(const WsConnection::Settings &settings)
+{
+    connection.setSettings(settings);
+}
+
+WsConnection::Stats OrderManager::connectionStats() const
+{
+    return connection.stats();
+}
+
 void OrderManager::run()
 {
     if (running)
         return;
     running = true;
-    thread = std::thread([this]
-                         {
-        this->doResolve();
-        ioc.run(); });
+    events.start();
+    connection.start();
 }
 
 void OrderManager::stop()
@@ -28,249 +91,418 @@ void OrderManager::stop()
         return;
     
     running = false;
-    
-    boost::asio::post(strand, [this]() {
-        beast::error_code ec;
-        
-        if (ws.is_open()) {
-            ws.async_close(beast::websocket::close_code::normal, 
-                [this](beast::error_code ec) {
-                    if (ec) {
-                        std::cerr << "WebSocket close error: " << ec.message() << "\n";
-                    }
-                    
-                    beast::error_code ssl_ec;
-                    ws.next_layer().async_shutdown([this](beast::error_code ec) {
-                        if (ec && ec != asio::error::eof) {
-                            std::cerr << "SSL shutdown error: " << ec.message() << "\n";
-                        }
-                        
-                        beast::error_code tcp_ec;
-                        ws.next_layer().next_layer().shutdown(tcp::socket::shutdown_both, tcp_ec);
-                        if (tcp_ec && tcp_ec != asio::error::not_connected) {
-                            std::cerr << "TCP shutdown error: " << tcp_ec.message() << "\n";
-                        }
-                        
-                        ioc.stop();
-                    });
-                });
-        } else {
-            ioc.stop();
-        }
-    });
-    
-    if (thread.joinable()) {
-        thread.join();
-    }
+    connection.stopAndWait(std::chrono::seconds(2));
+    events.stop();
 }
 
-void OrderManager::doResolve()
+void OrderManager::onOpen(bool reconnected)
 {
-    resolver.async_resolve(
-        host, port, beast::bind_front_handler(&OrderManager::onResolve, this));
+    if (reconnected)
+        resync();
+    // cancels held while the session was down
+    if (outboxCount != 0 && !writeInFlight)
+        writeNext();
 }
 
-void OrderManager::onResolve(beast::error_code ec, tcp::resolver::results_type results)
+void OrderManager::onClose()
 {
-    if (ec)
+    // the write in flight may or may not have reached the exchange; a place is already in
+    // awaitingAck and settled by resync, anything else goes out again on the next session
+    if (writeInFlight && outbox[outboxHead]->placing != InvalidOrderId)
     {
-        std::cerr << "Resolve error: " << ec.message() << "\n";
-        return;
+        outboxHead = (outboxHead + 1) % outbox.size();
+        --outboxCount;
     }
-    
-    asio::async_connect(
-        ws.next_layer().next_layer(), results, 
-        beast::bind_front_handler(&OrderManager::onConnect, this));
+    writeInFlight = false;
+
+    // queued places never left, their prices will be stale by the time the session is back
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < outboxCount; ++i)
+    {
+        auto &slot = outbox[(outboxHead + i) % outbox.size()];
+        if (slot->placing != InvalidOrderId)
+            closeUnsent(slot->placing, OrderStatus::REJECTED);
+        else
+            std::swap(outbox[(outboxHead + kept++) % outbox.size()], slot);
+    }
+    outboxCount = kept;
+    depthGauge.store(outboxCount, std::memory_order_relaxed);
 }
 
-void OrderManager::onConnect(beast::error_code ec, tcp::endpoint)
+void OrderManager::resync()
 {
-    if (ec)
+    // a fill or cancel on a resting order, or the answer to a place in flight, may have been lost
+    std::vector<std::pair<OrderId, SymbolId>> queries;
     {
-        std::cerr << "Connect error: " << ec.message() << "\n";
-        return;
-    }
-    
-    if (!SSL_set_tlsext_host_name(ws.next_layer().native_handle(), host.c_str())) {
-        std::cerr << "Failed to set SNI hostname\n";
+        std::lock_guard lock(mu);
+        orders.forEach([&queries](const Order &order)
+                       {
+            if (order.status == OrderStatus::ACKED || order.status == OrderStatus::PARTIAL)
+                queries.emplace_back(order.id, order.symbol); });
+        // kept until an answer arrives, so a session that drops again before then asks again
+        awaitingAck.erase(std::remove_if(awaitingAck.begin(), awaitingAck.end(), [this, &queries](OrderId id)
+                                         {
+            const Order *order = orders.find(id);
+            if (!order || order->status != OrderStatus::NEW)
+                return true;
+            queries.emplace_back(id, order->symbol);
+            return false; }),
+                          awaitingAck.end());
     }
-    
-    ws.next_layer().async_handshake(
-        ssl::stream_base::client, 
-        beast::bind_front_handler(&OrderManager::onSslHandShake, this));
+    HFT_LOG_INFO("order entry: resyncing {} orders", queries.size());
+    // metered like everything else, a reconnect with many open orders must not burst the weight window
+    scheduler.clearStatus();
+    for (const auto &[id, symbol] : queries)
+        scheduler.queueStatus(id, symbol);
+    schedule();
 }
 
-void OrderManager::onSslHandShake(beast::error_code ec)
+void OrderManager::onFrame(const char *data, std::size_t size)
 {
-    if (ec)
+    try
     {
-        std::cerr << "SSL handshake error: " << ec.message() << "\n";
-        return;
-    }
-    
-    ws.set_option(beast::websocket::stream_base::timeout::suggested(
-        beast::role_type::client));
-    
-    ws.set_option(beast::websocket::stream_base::decorator(
-        [](beast::websocket::request_type& req)
+        // parsed where it lies in the receive buffer; the echo copies it into the log, debug builds only
+        const std::string_view payload(data, size);
+        HFT_LOG_DEBUG("Received: {}", payload);
+
+        auto json_response = nlohmann::json::parse(payload.begin(), payload.end());
+        readRateLimits(json_response);
+
+        if (json_response.contains("id") && json_response["id"].is_string())
         {
-            req.set(beast::http::field::user_agent, 
-                std::string(BOOST_BEAST_VERSION_STRING) + " websocket-client-async-ssl");
-        }));
-    
-    const std::string target = "/ws-api/v3";  
-    const std::string hostHeader = host + ":" + port;
-    
-    ws.async_handshake(hostHeader, target, 
-        beast::bind_front_handler(&OrderManager::onWsHandshake, this));
+            const std::string &wireId = json_response["id"].get_ref<const std::string &>();
+            std::string_view suffix;
+            OrderId id = OrderStore::parseId(wireId, &suffix);
+            const bool failed = json_response.contains("error") || json_response.contains("code");
+            
+            // ws-api wraps failures in "error" and the order in "result"
+            if (failed && suffix != "status") {
+                const auto &err = json_response.contains("error") ? json_response["error"] : json_response;
+                HFT_LOG_WARN("Order error - Code: {}, Message: {}", err.value("code", 0), err.value("msg", "Unknown error"));
+            }
+
+            // whatever the answer, the order's outcome is known now
+            if (suffix != "cancel")
+            {
+                auto waiting = std::find(awaitingAck.begin(), awaitingAck.end(), id);
+                if (waiting != awaitingAck.end())
+                {
+                    *waiting = awaitingAck.back();
+                    awaitingAck.pop_back();
+                }
+            }
+
+            if (id == InvalidOrderId) {
+                HFT_LOG_WARN("Response for unknown id {}", wireId);
+            } else if (suffix == "cancel") {
+                handleCancelAcknowledge(id, !failed);
+            } else if (suffix == "amend") {
+                handleCancelReplaceAcknowledge(id, json_response);
+            } else if (suffix == "status") {
+                handleStatus(id, json_response);
+            } else if (failed) {
+                handleExchangeAcknowledge(id, Fixed(), Fixed(), false);
+            } else {
+                const auto &result = json_response.contains("result") ? json_response["result"] : json_response;
+                Fixed fillQty;
+                Fixed fillPrice;
+                bool success = true;
+                readResult(result, fillQty, fillPrice, success);
+                handleExchangeAcknowledge(id, fillQty, fillPrice, success);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        HFT_LOG_ERROR("Error parsing order response: {}", e.what());
+    }
+
+    // a response may have opened a window or lifted a ban
+    schedule();
 }
 
-void OrderManager::onWsHandshake(beast::error_code ec)
+OrderId OrderManager::sendOrder(OrderSide side, Fixed quantity, Fixed price, SymbolId symbol)
 {
-    if (ec)
+    OrderRequest request{symbol, side, quantity, price};
+    OrderId id = InvalidOrderId;
+    sendOrders(&request, 1, &id);
+    return id;
+}
+
+void OrderManager::sendOrders(const OrderRequest *requests, std::size_t count, OrderId *ids)
+{
+    while (count > 0)
     {
-        std::cerr << "WebSocket handshake error: " << ec.message() << "\n";
-        return;
+        Batch batch;
+        batch.count = std::min(count, MaxBatch);
+        batch.traceOrigin = HFT_TRACE_ORIGIN();
+        {
+            std::lock_guard lock(mu);
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                Order order;
+                order.symbol = requests[i].symbol;
+                order.side = requests[i].side;
+                order.price = requests[i].price;
+                order.quantity = requests[i].quantity;
+                order.status = OrderStatus::NEW;
+                order.traceOrigin = batch.traceOrigin;
+                ids[i] = orders.insert(order);
+                batch.legs[i] = {ids[i], requests[i]};
+            }
+        }
+
+        // only the raw fields cross to the strand, messages are rendered straight into outbox slots
+        // once the scheduler lets them go
+        boost::asio::post(strand, [this, batch]() {
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                const OrderId replaced = scheduler.queuePlace({batch.legs[i].first, batch.legs[i].second, batch.traceOrigin, InvalidOrderId});
+                if (replaced != InvalidOrderId)
+                    closeUnsent(replaced, OrderStatus::CANCELED);
+            }
+            schedule();
+        });
+
+        requests += batch.count;
+        ids += batch.count;
+        count -= batch.count;
     }
-    
-    std::cout << "OrderManager WebSocket connected successfully\n";
-    
-    ws.async_read(buffer, beast::bind_front_handler(&OrderManager::onRead, this));
 }
 
-void OrderManager::onRead(beast::error_code ec, std::size_t bytes_transferred)
+void OrderManager::encodeOrder(const OrderScheduler::Pending &next)
 {
-    if (ec)
+    char wireId[OrderStore::MaxWireIdSize];
+    const std::size_t wireIdSize = OrderStore::formatId(wireId, next.id);
+    const OrderRequest &request = next.request;
+    Outgoing &out = nextOutgoing();
+    out.placing = next.id;
+    if (next.replaces == InvalidOrderId)
     {
-        std::cerr << "Read error: " << ec.message() << "\n";
-        return;
+        out.size = encoder.encodePlace(out.bytes.data(), out.bytes.size(), std::string_view(wireId, wireIdSize),
+                                       request.symbol, request.side, request.quantity, request.price);
     }
-    
-    if (!running)
+    else
     {
+        // the scheduler may have folded amends together, the store learns the final pairing here
+        {
+            std::lock_guard lock(mu);
+            if (Order *order = orders.find(next.id))
+                order->replaces = next.replaces;
+        }
+        char origId[OrderStore::MaxWireIdSize];
+        const std::size_t origIdSize = OrderStore::formatId(origId, next.replaces);
+        out.size = encoder.encodeCancelReplace(out.bytes.data(), out.bytes.size(), std::string_view(wireId, wireIdSize),
+                                               std::string_view(origId, origIdSize), request.symbol, request.side,
+                                               request.quantity, request.price);
+    }
+    out.traceOrigin = next.traceOrigin;
+    if (out.size == 0)
+    {
+        HFT_LOG_ERROR("Cannot encode order {}", next.id);
+        handleExchangeAcknowledge(next.id, Fixed(), Fixed(), false);
         return;
     }
+    HFT_TRACE_STAGE_FROM(Serialized, next.traceOrigin);
+    HFT_LOG_INFO("Sending order: {}", std::string_view(out.bytes.data(), out.size));
+    doSend();
+}
 
-    try
+void OrderManager::cancelOrder(OrderId id)
+{
+    SymbolId symbol = InvalidSymbol;
     {
-        std::string payload = beast::buffers_to_string(buffer.data());
-        buffer.consume(buffer.size());
-
-        std::cout << "Received: " << payload << "\n";
+        std::lock_guard lock(mu);
+        if (const Order *order = orders.find(id))
+            symbol = order->symbol;
+    }
+    if (symbol == InvalidSymbol)
+    {
+        HFT_LOG_WARN("Cannot cancel unknown order {}", id);
+        return;
+    }
 
-        auto json_response = nlohmann::json::parse(payload);
+    boost::asio::post(strand, [this, id, symbol, origin = HFT_TRACE_ORIGIN()]() {
+        scheduler.queueCancel(id, symbol, origin);
+        schedule();
+    });
+}
 
-        if (json_response.contains("id"))
+OrderId OrderManager::amendOrder(OrderId id, Fixed quantity, Fixed price)
+{
+    OrderRequest request;
+    OrderId replacement = InvalidOrderId;
+    const int64_t origin = HFT_TRACE_ORIGIN();
+    {
+        std::lock_guard lock(mu);
+        const Order *original = orders.find(id);
+        if (!original)
         {
-            std::string clientId = json_response["id"];
-            
-            if (json_response.contains("code")) {
-                std::cerr << "Order error - Code: " << json_response["code"] 
-                         << ", Message: " << json_response.value("msg", "Unknown error") << "\n";
-                handleExchangeAcknowledge(clientId, 0.0, 0.0, false);
-            } else {
-                double fillQty = 0.0;
-                double fillPrice = 0.0;
-                bool success = true;
-                
-                if (json_response.contains("executedQty")) {
-                    fillQty = std::stod(json_response["executedQty"].get<std::string>());
-                }
-                if (json_response.contains("price")) {
-                    fillPrice = std::stod(json_response["price"].get<std::string>());
-                }
-                
-                std::string status = json_response.value("status", "");
-                success = (status != "REJECTED");
-                
-                handleExchangeAcknowledge(clientId, fillQty, fillPrice, success);
-            }
+            HFT_LOG_WARN("Cannot amend unknown order {}", id);
+            return InvalidOrderId;
         }
+        request = OrderRequest{original->symbol, original->side, quantity, price};
+
+        // replaces stays unset until the cancel-replace actually leaves, see encodeOrder
+        Order order;
+        order.symbol = request.symbol;
+        order.side = request.side;
+        order.price = price;
+        order.quantity = quantity;
+        order.status = OrderStatus::NEW;
+        order.traceOrigin = origin;
+        replacement = orders.insert(order);
     }
-    catch (const std::exception &e)
+
+    boost::asio::post(strand, [this, pending = OrderScheduler::Pending{replacement, request, origin, id}]() {
+        const OrderId replaced = scheduler.queuePlace(pending);
+        if (replaced != InvalidOrderId)
+            closeUnsent(replaced, OrderStatus::CANCELED);
+        schedule();
+    });
+    return replacement;
+}
+
+void OrderManager::encodeCancel(OrderId id, SymbolId symbol, int64_t traceOrigin)
+{
+    char wireId[OrderStore::MaxWireIdSize];
+    const std::size_t wireIdSize = OrderStore::formatId(wireId, id);
+    Outgoing &out = nextOutgoing();
+    out.size = encoder.encodeCancel(out.bytes.data(), out.bytes.size(), std::string_view(wireId, wireIdSize), symbol);
+    out.traceOrigin = traceOrigin;
+    out.placing = InvalidOrderId;
+    if (out.size == 0)
     {
-        std::cerr << "Error parsing order response: " << e.what() << "\n";
+        HFT_LOG_ERROR("Cannot encode cancel for {}", id);
+        return;
     }
+    doSend();
+}
 
-    ws.async_read(buffer, beast::bind_front_handler(&OrderManager::onRead, this));
+void OrderManager::encodeStatus(OrderId id, SymbolId symbol)
+{
+    char wireId[OrderStore::MaxWireIdSize];
+    const std::size_t wireIdSize = OrderStore::formatId(wireId, id);
+    Outgoing &out = nextOutgoing();
+    out.size = encoder.encodeStatus(out.bytes.data(), out.bytes.size(), std::string_view(wireId, wireIdSize), symbol);
+    out.traceOrigin = 0;
+    out.placing = InvalidOrderId;
+    if (out.size == 0)
+    {
+        HFT_LOG_ERROR("Cannot encode status query for {}", id);
+        return;
+    }
+    doSend();
 }
 
-std::string OrderManager::sendOrder(OrderSide side, double quantity, double price, const std::string &symbol)
+void OrderManager::schedule()
 {
-    std::string id = "client_" + std::to_string(nextId.fetch_add(1));
-    
-    Order order;
-    order.symbol = symbol;
-    order.clientId = id;
-    order.side = side;
-    order.price = price;
-    order.quantity = quantity;
-    order.status = OrderStatus::NEW;
+    OrderScheduler::Pending next;
+    while (true)
+    {
+        const OrderScheduler::Next kind = scheduler.next(epochMillis(), next);
+        if (kind == OrderScheduler::Next::Place)
+        {
+            encodeOrder(next);
+        }
+        else if (kind == OrderScheduler::Next::Cancel)
+        {
+            encodeCancel(next.id, next.request.symbol, next.traceOrigin);
+        }
+        else if (kind == OrderScheduler::Next::Status)
+        {
+            encodeStatus(next.id, next.request.symbol);
+        }
+        else
+        {
+            if (kind == OrderScheduler::Next::Throttled && !throttleArmed)
+            {
+                const int64_t now = epochMillis();
+                throttleArmed = true;
+                throttleTimer.expires_after(std::chrono::milliseconds(scheduler.resumeAt(now) - now));
+                throttleTimer.async_wait([this](beast::error_code ec) {
+                    throttleArmed = false;
+                    if (!ec && running)
+                        schedule();
+                });
+            }
+            break;
+        }
+    }
+    scheduledGauge.store(scheduler.queued(), std::memory_order_relaxed);
+}
 
+void OrderManager::closeUnsent(OrderId id, OrderStatus status)
+{
+    Order updated;
     {
         std::lock_guard lock(mu);
-        orders.emplace(id, order);
-    }
-
-    nlohmann::json j;
-    j["id"] = id;
-    j["method"] = "order.place";
-    j["params"] = {
-        {"symbol", symbol},
-        {"side", (side == OrderSide::BUY ? "BUY" : "SELL")},
-        {"type", "LIMIT"},
-        {"timeInForce", "GTC"},
-        {"quantity", std::to_string(quantity)},
-        {"price", std::to_string(price)},
-        {"newClientOrderId", id}
-    };
-
-    auto message = j.dump();
-    
-    std::cout << "Sending order: " << message << "\n";
-
-    boost::asio::post(strand, [this, msg = std::move(message)]() { 
-        doSend(msg); 
-    });
+        Order *found = orders.find(id);
+        if (!found)
+            return;
+        found->status = status;
+        updated = *found;
+        orders.release(id);
+    }
 
-    return id;
+    events.publish(updated);
 }
 
-void OrderManager::cancelOrder(const std::string &clientId)
+void OrderManager::readRateLimits(const json &response)
 {
-    nlohmann::json j;
-    j["id"] = clientId + "_cancel";
-    j["method"] = "order.cancel";
-    j["params"] = {
-        {"origClientOrderId", clientId}
-    };
-    
-    auto message = j.dump();
-    
-    boost::asio::post(strand, [this, msg = std::move(message)]() { 
-        doSend(msg); 
-    });
-}
+    const int64_t now = epochMillis();
+    auto limits = response.find("rateLimits");
+    if (limits != response.end() && limits->is_array())
+    {
+        for (const auto &limit : *limits)
+        {
+            const std::string type = limit.value("rateLimitType", "");
+            OrderScheduler::LimitType kind;
+            if (type == "ORDERS")
+                kind = OrderScheduler::LimitType::Orders;
+            else if (type == "REQUEST_WEIGHT")
+                kind = OrderScheduler::LimitType::RequestWeight;
+            else
+                continue;
+            scheduler.updateLimit(kind, OrderScheduler::intervalMs(limit.value("interval", ""), limit.value("intervalNum", int64_t{1})),
+                                  limit.value("limit", int64_t{0}), limit.value("count", int64_t{0}), now);
+        }
+    }
 
-void OrderManager::onOrderUpdate(OrderCallback cb)
-{
-    callback = std::move(cb);
+    // 429 is a warning, 418 an ip ban; both carry the time trading may resume when the exchange knows it
+    const int status = response.value("status", 0);
+    if (status == 429 || status == 418)
+    {
+        int64_t until = now + 1000;
+        auto error = response.find("error");
+        if (error != response.end() && error->is_object() && error->contains("data"))
+        {
+            const auto &data = (*error)["data"];
+            if (data.is_object())
+                until = std::max(until, data.value("retryAfter", int64_t{0}));
+        }
+        scheduler.pauseUntil(until);
+    }
 }
 
-void OrderManager::handleExchangeAcknowledge(const std::string &clientId, double filledQuantity, double filledPrice, bool success)
+void OrderManager::handleExchangeAcknowledge(OrderId id, Fixed filledQuantity, Fixed filledPrice, bool success)
 {
     Order updated;
     {
         std::lock_guard lock(mu);
-        auto it = orders.find(clientId);
-        if (it == orders.end())
+        Order *found = orders.find(id);
+        if (!found)
         {
-            std::cerr << "Order not found in order book: " << clientId << "\n";
+            HFT_LOG_WARN("Order not found in order book: {}", id);
             return;
         }
         
-        Order &origOrder = it->second;
-        double originalQty = origOrder.quantity;
+        Order &origOrder = *found;
+        const Fixed originalQty = origOrder.quantity;
+        if (origOrder.status == OrderStatus::NEW)
+        {
+            HFT_TRACE_STAGE_FROM(Ack, origOrder.traceOrigin);
+        }
 
         updated = origOrder;
         updated.lastFillQuantity = filledQuantity;
@@ -280,7 +512,7 @@ void OrderManager::handleExchangeAcknowledge(const std::string &clientId, double
         {
             updated.status = OrderStatus::REJECTED;
         }
-        else if (filledQuantity == 0.0)
+        else if (filledQuantity.isZero())
         {
             updated.status = OrderStatus::ACKED;
         }
@@ -292,34 +524,229 @@ void OrderManager::handleExchangeAcknowledge(const std::string &clientId, double
         else
         {
             updated.status = OrderStatus::FILLED;
-            updated.quantity = 0.0;
+            updated.quantity = Fixed();
         }
         
-        it->second = updated;
+        origOrder = updated;
+        if (updated.status == OrderStatus::FILLED || updated.status == OrderStatus::REJECTED)
+        {
+            orders.release(id);
+        }
     }
     
-    if (callback)
+    events.publish(updated);
+}
+
+void OrderManager::handleCancelAcknowledge(OrderId id, bool success)
+{
+    Order updated;
     {
-        callback(updated);
+        std::lock_guard lock(mu);
+        Order *found = orders.find(id);
+        if (!found)
+        {
+            HFT_LOG_WARN("Cancel for an order no longer live: {}", id);
+            return;
+        }
+        if (!success)
+        {
+            // the order stays as it was, a fill or the exchange's own cancel will close it
+            return;
+        }
+        found->status = OrderStatus::CANCELED;
+        found->lastFillQuantity = Fixed();
+        found->lastFillPrice = Fixed();
+        updated = *found;
+        orders.release(id);
     }
+
+    events.publish(updated);
 }
 
-void OrderManager::doSend(const std::string &payload)
+void OrderManager::handleCancelReplaceAcknowledge(OrderId id, const json &response)
 {
-    if (!ws.is_open()) {
-        std::cerr << "WebSocket is not open, cannot send message\n";
+    OrderId replaced = InvalidOrderId;
+    {
+        std::lock_guard lock(mu);
+        if (const Order *order = orders.find(id))
+            replaced = order->replaces;
+    }
+
+    // both outcomes sit in result on success and in error.data when either leg failed,
+    // an error without data means neither leg was attempted
+    const json *outcome = nullptr;
+    auto result = response.find("result");
+    auto error = response.find("error");
+    if (result != response.end() && result->is_object())
+        outcome = &*result;
+    else if (error != response.end() && error->is_object() && error->contains("data") && (*error)["data"].is_object())
+        outcome = &(*error)["data"];
+
+    // the cancel leg closes first so listeners never see both orders live after an amend
+    if (outcome && replaced != InvalidOrderId && outcome->value("cancelResult", "") == "SUCCESS")
+        handleCancelAcknowledge(replaced, true);
+
+    auto placed = outcome ? outcome->find("newOrderResponse") : response.end();
+    if (outcome && outcome->value("newOrderResult", "") == "SUCCESS" && placed != outcome->end() && placed->is_object())
+    {
+        Fixed fillQty;
+        Fixed fillPrice;
+        bool success = true;
+        readResult(*placed, fillQty, fillPrice, success);
+        handleExchangeAcknowledge(id, fillQty, fillPrice, success);
+    }
+    else
+    {
+        handleExchangeAcknowledge(id, Fixed(), Fixed(), false);
+    }
+}
+
+void OrderManager::handleStatus(OrderId id, const json &response)
+{
+    OrderStatus local;
+    Fixed open;
+    {
+        std::lock_guard lock(mu);
+        const Order *order = orders.find(id);
+        if (!order)
+            return;
+        local = order->status;
+        open = order->quantity;
+    }
+
+    auto error = response.find("error");
+    if (error != response.end() && error->is_object())
+    {
+        // -2013: the exchange has no such order, a place lost with the session never arrived
+        if (error->value("code", 0) != -2013)
+        {
+            HFT_LOG_WARN("Status query for {} failed: {}", id, error->value("msg", "Unknown error"));
+            return;
+        }
+        if (local == OrderStatus::NEW)
+            handleExchangeAcknowledge(id, Fixed(), Fixed(), false);
+        else
+            handleCancelAcknowledge(id, true);
         return;
     }
-    
-    ws.async_write(
-        asio::buffer(payload),
-        asio::bind_executor(strand, [this, payload](beast::error_code ec, std::size_t bytes_written)
+    auto result = response.find("result");
+    if (result == response.end() || !result->is_object())
+        return;
+
+    const std::string status = result->value("status", "");
+    if (status == "REJECTED")
+    {
+        handleExchangeAcknowledge(id, Fixed(), Fixed(), false);
+        return;
+    }
+    // what filled while we were away: the store holds the open quantity, the exchange the
+    // executed one; without executions nothing filled, whatever lot rounding did to origQty
+    Fixed fill;
+    const Fixed executed = readDecimal(*result, "executedQty");
+    if (status == "FILLED")
+        fill = open;
+    else if (!executed.isZero() && open > readDecimal(*result, "origQty") - executed)
+        fill = open - (readDecimal(*result, "origQty") - executed);
+
+    if (!fill.isZero())
+        handleExchangeAcknowledge(id, fill, readDecimal(*result, "price"), true);
+    else if (local == OrderStatus::NEW)
+        handleExchangeAcknowledge(id, Fixed(), Fixed(), true);
+    if (status == "CANCELED" || status == "EXPIRED")
+        handleCancelAcknowledge(id, true);
+}
+
+OrderManager::Outgoing &OrderManager::nextOutgoing()
+{
+    if (outboxCount == outbox.size())
+    {
+        // slots are heap-stable, so growing never moves the buffer of the write in flight
+        std::vector<std::unique_ptr<Outgoing>> grown(outbox.size() * 2);
+        for (std::size_t i = 0; i < outboxCount; ++i)
+            grown[i] = std::move(outbox[(outboxHead + i) % outbox.size()]);
+        for (std::size_t i = outboxCount; i < grown.size(); ++i)
+            grown[i] = std::make_unique<Outgoing>();
+        outbox = std::move(grown);
+        outboxHead = 0;
+    }
+    return *outbox[(outboxHead + outboxCount) % outbox.size()];
+}
+
+void OrderManager::doSend()
+{
+    Outgoing &out = *outbox[(outboxHead + outboxCount) % outbox.size()];
+    if (!connection.isOpen() && out.placing != InvalidOrderId)
+    {
+        // no session to carry it, the strategy quotes again once one is back
+        HFT_LOG_WARN("Order entry disconnected, rejecting order {}", out.placing);
+        closeUnsent(out.placing, OrderStatus::REJECTED);
+        return;
+    }
+
+    out.queuedAt = steadyNanos();
+    ++outboxCount;
+    depthGauge.store(outboxCount, std::memory_order_relaxed);
+    if (outboxCount > maxDepth.load(std::memory_order_relaxed))
+        maxDepth.store(outboxCount, std::memory_order_relaxed);
+
+    // beast allows one write in flight, the rest wait here and go out as soon as it completes;
+    // cancels queued while disconnected wait for onOpen
+    if (!writeInFlight && connection.isOpen())
+    {
+        writeNext();
+    }
+}
+
+void OrderManager::writeNext()
+{
+    const Outgoing &out = *outbox[outboxHead];
+    queueDelay.record(static_cast<uint64_t>(std::max<int64_t>(0, steadyNanos() - out.queuedAt)));
+    if (out.placing != InvalidOrderId)
+        awaitingAck.push_back(out.placing);
+    writeInFlight = true;
+    // the stream stays alive until the completion runs, even if a reconnect replaced it by then
+    const std::shared_ptr<WsConnection::Stream> &stream = connection.stream();
+    stream->async_write(
+        asio::buffer(out.bytes.data(), out.size),
+        asio::bind_executor(strand, [this, stream, generation = connection.generation()](beast::error_code ec, std::size_t bytes_written)
         {
+            // the session ended under the write, onClose has sorted out the outbox already
+            if (generation != connection.generation())
+                return;
+            writeInFlight = false;
+            const Outgoing &done = *outbox[outboxHead];
             if (ec) {
-                std::cerr << "Send error: " << ec.message() << "\n";
-                std::cerr << "Failed to send: " << payload << "\n";
+                HFT_LOG_ERROR("Send error: {}, failed to send: {}", ec.message(), std::string_view(done.bytes.data(), done.size));
+                connection.fail("write", ec);
                 return;
             }
-            std::cout << "Successfully sent " << bytes_written << " bytes\n";
+            HFT_TRACE_STAGE_FROM(WriteDone, done.traceOrigin);
+            written.fetch_add(1, std::memory_order_relaxed);
+            outboxHead = (outboxHead + 1) % outbox.size();
+            depthGauge.store(--outboxCount, std::memory_order_relaxed);
+            // chain the next message before anything else, this is the gap between pair legs
+            if (outboxCount != 0)
+            {
+                writeNext();
+            }
+            HFT_LOG_DEBUG("Successfully sent {} bytes", bytes_written);
         }));
 }
+
+OutboxStats OrderManager::outboxStats() const
+{
+    return OutboxStats{depthGauge.load(std::memory_order_relaxed), maxDepth.load(std::memory_order_relaxed),
+                       written.load(std::memory_order_relaxed), queueDelay.percentile(0.50),
+                       queueDelay.percentile(0.99), queueDelay.max()};
+}
+
+std::size_t OrderManager::orderHeadroom() const
+{
+    return scheduler.orderHeadroom(epochMillis());
+}
+
+SchedulerStats OrderManager::schedulerStats() const
+{
+    return SchedulerStats{scheduledGauge.load(std::memory_order_relaxed), scheduler.superseded(),
+                          scheduler.throttled(), orderHeadroom()};
+}
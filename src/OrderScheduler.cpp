@@ -0,0 +1,218 @@
+#include <OrderScheduler.hpp>
+#include <algorithm>
+#include <limits>
+
+OrderScheduler::OrderScheduler()
+    : headroom(std::numeric_limits<std::size_t>::max()), refilled(std::numeric_limits<std::size_t>::max()),
+      refillAt(std::numeric_limits<int64_t>::max())
+{
+    windows.reserve(8);
+    cancels.reserve(64);
+    places.reserve(64);
+    queries.reserve(64);
+}
+
+int64_t OrderScheduler::intervalMs(std::string_view interval, int64_t intervalNum)
+{
+    int64_t unit = 0;
+    if (interval == "SECOND")
+        unit = 1000;
+    else if (interval == "MINUTE")
+        unit = 60 * 1000;
+    else if (interval == "HOUR")
+        unit = 60 * 60 * 1000;
+    else if (interval == "DAY")
+        unit = 24 * 60 * 60 * 1000;
+    return unit * std::max<int64_t>(intervalNum, 0);
+}
+
+void OrderScheduler::roll(Window &window, int64_t nowMs) const
+{
+    const int64_t start = nowMs - nowMs % window.intervalMs;
+    if (start != window.start)
+    {
+        window.start = start;
+        window.used = 0;
+    }
+}
+
+void OrderScheduler::updateLimit(LimitType type, int64_t intervalMs, int64_t limit, int64_t count, int64_t nowMs)
+{
+    if (intervalMs <= 0 || limit <= 0)
+        return;
+    auto it = std::find_if(windows.begin(), windows.end(), [&](const Window &w)
+                           { return w.type == type && w.intervalMs == intervalMs; });
+    if (it == windows.end())
+    {
+        windows.push_back(Window{type, intervalMs, limit, 0, 0});
+        it = windows.end() - 1;
+    }
+    it->limit = limit;
+    roll(*it, nowMs);
+    // the exchange's count lags whatever is still in flight, so only ever move up
+    it->used = std::max(it->used, count);
+    publishHeadroom();
+}
+
+void OrderScheduler::pauseUntil(int64_t untilMs)
+{
+    pausedUntil = std::max(pausedUntil, untilMs);
+}
+
+void OrderScheduler::queueCancel(OrderId id, SymbolId symbol, int64_t traceOrigin)
+{
+    Pending pending;
+    pending.id = id;
+    pending.request.symbol = symbol;
+    pending.traceOrigin = traceOrigin;
+    cancels.push_back(pending);
+}
+
+OrderId OrderScheduler::queuePlace(const Pending &pending)
+{
+    for (Pending &queued : places)
+    {
+        if (queued.request.symbol == pending.request.symbol && queued.request.side == pending.request.side)
+        {
+            // keeps the queue position, only the content is newer
+            const OrderId replaced = queued.id;
+            const OrderId resting = queued.replaces;
+            queued = pending;
+            // an amend of the unsent amend takes over its resting order; a plain place (or an amend
+            // of some other order) must not cancel-replace an order it never named, so the cancel
+            // the superseded amend implied goes out on its own
+            if (pending.replaces == replaced)
+                queued.replaces = resting;
+            else if (resting != InvalidOrderId)
+                queueCancel(resting, pending.request.symbol, pending.traceOrigin);
+            supersededCount.fetch_add(1, std::memory_order_relaxed);
+            return replaced;
+        }
+    }
+    places.push_back(pending);
+    return InvalidOrderId;
+}
+
+void OrderScheduler::queueStatus(OrderId id, SymbolId symbol)
+{
+    Pending pending;
+    pending.id = id;
+    pending.request.symbol = symbol;
+    queries.push_back(pending);
+}
+
+bool OrderScheduler::fits(int64_t nowMs, bool place, int64_t weight)
+{
+    if (nowMs < pausedUntil)
+        return false;
+    for (Window &w : windows)
+    {
+        if (w.type == LimitType::Orders && !place)
+            continue;
+        roll(w, nowMs);
+        if (w.used + (w.type == LimitType::Orders ? 1 : weight) > w.limit)
+            return false;
+    }
+    return true;
+}
+
+void OrderScheduler::charge(bool place, int64_t weight)
+{
+    for (Window &w : windows)
+    {
+        if (w.type == LimitType::Orders && !place)
+            continue;
+        w.used += w.type == LimitType::Orders ? 1 : weight;
+    }
+    publishHeadroom();
+}
+
+bool OrderScheduler::peek(bool &place, int64_t &weight) const
+{
+    place = false;
+    if (!cancels.empty())
+        weight = CancelWeight;
+    else if (!queries.empty())
+        weight = StatusWeight;
+    else if (!places.empty())
+    {
+        place = true;
+        weight = places.front().replaces == InvalidOrderId ? PlaceWeight : CancelReplaceWeight;
+    }
+    else
+        return false;
+    return true;
+}
+
+void OrderScheduler::publishHeadroom()
+{
+    constexpr std::size_t unknown = std::numeric_limits<std::size_t>::max();
+    int64_t nextRoll = std::numeric_limits<int64_t>::max();
+    for (const Window &w : windows)
+    {
+        if (w.type == LimitType::Orders)
+            nextRoll = std::min(nextRoll, w.start + w.intervalMs);
+    }
+
+    // what is left now, and what is left once the earliest window starts over
+    std::size_t room = unknown;
+    std::size_t after = unknown;
+    for (const Window &w : windows)
+    {
+        if (w.type != LimitType::Orders)
+            continue;
+        const auto left = static_cast<std::size_t>(std::max<int64_t>(0, w.limit - w.used));
+        room = std::min(room, left);
+        after = std::min(after, w.start + w.intervalMs == nextRoll ? static_cast<std::size_t>(w.limit) : left);
+    }
+    // orders already waiting here take their share first
+    const std::size_t waiting = places.size();
+    room = room == unknown ? room : room > waiting ? room - waiting : 0;
+    after = after == unknown ? after : after > waiting ? after - waiting : 0;
+
+    // readers check refillAt first, so park it while the pair changes
+    refillAt.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+    headroom.store(room, std::memory_order_relaxed);
+    refilled.store(after, std::memory_order_relaxed);
+    refillAt.store(nextRoll, std::memory_order_release);
+}
+
+OrderScheduler::Next OrderScheduler::next(int64_t nowMs, Pending &out)
+{
+    bool place = false;
+    int64_t weight = 0;
+    if (!peek(place, weight))
+        return Next::None;
+    if (!fits(nowMs, place, weight))
+    {
+        throttledCount.fetch_add(1, std::memory_order_relaxed);
+        if (place)
+            publishHeadroom();
+        return Next::Throttled;
+    }
+    std::vector<Pending> &queue = !cancels.empty() ? cancels : !queries.empty() ? queries : places;
+    const Next kind = !cancels.empty() ? Next::Cancel : !queries.empty() ? Next::Status : Next::Place;
+    out = queue.front();
+    queue.erase(queue.begin());
+    charge(place, weight);
+    return kind;
+}
+
+int64_t OrderScheduler::resumeAt(int64_t nowMs) const
+{
+    int64_t at = std::max(nowMs, pausedUntil);
+    bool place = false;
+    int64_t weight = 0;
+    if (!peek(place, weight))
+        return at;
+    for (const Window &w : windows)
+    {
+        if (w.type == LimitType::Orders && !place)
+            continue;
+        const int64_t start = nowMs - nowMs % w.intervalMs;
+        const int64_t used = start == w.start ? w.used : 0;
+        if (used + (w.type == LimitType::Orders ? 1 : weight) > w.limit)
+            at = std::max(at, start + w.intervalMs);
+    }
+    return at;
+}
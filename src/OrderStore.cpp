@@ -0,0 +1,116 @@
+#include <OrderStore.hpp>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    constexpr std::string_view WirePrefix = "client_";
+}
+
+OrderStore::OrderStore(std::size_t initialCapacity)
+{
+    do
+    {
+        addSlab();
+    } while (capacity() < initialCapacity);
+}
+
+void OrderStore::addSlab()
+{
+    const uint32_t first = static_cast<uint32_t>(capacity());
+    slabs.push_back(std::make_unique<Slot[]>(SlabSize));
+    freeSlots.reserve(capacity());
+    // lowest slot on top, a fresh store hands out 0, 1, 2, ...
+    for (uint32_t i = SlabSize; i > 0; --i)
+        freeSlots.push_back(first + i - 1);
+}
+
+OrderStore::Slot *OrderStore::slotOf(OrderId id)
+{
+    const uint32_t index = static_cast<uint32_t>(id);
+    if (index >= capacity())
+        return nullptr;
+    Slot &slot = slabs[index / SlabSize][index % SlabSize];
+    if (!slot.used || slot.generation != static_cast<uint32_t>(id >> 32))
+        return nullptr;
+    return &slot;
+}
+
+OrderId OrderStore::insert(const Order &order)
+{
+    if (freeSlots.empty())
+        addSlab();
+    const uint32_t index = freeSlots.back();
+    freeSlots.pop_back();
+
+    Slot &slot = slabs[index / SlabSize][index % SlabSize];
+    // generation 0 is never issued, so 0 stays the invalid id
+    if (++slot.generation == 0)
+        slot.generation = 1;
+    slot.used = true;
+    slot.order = order;
+    slot.order.id = (static_cast<OrderId>(slot.generation) << 32) | index;
+    ++liveCount;
+    return slot.order.id;
+}
+
+Order *OrderStore::find(OrderId id)
+{
+    Slot *slot = slotOf(id);
+    return slot ? &slot->order : nullptr;
+}
+
+void OrderStore::release(OrderId id)
+{
+    Slot *slot = slotOf(id);
+    if (!slot)
+        return;
+    slot->used = false;
+    freeSlots.push_back(static_cast<uint32_t>(id));
+    --liveCount;
+}
+
+std::size_t OrderStore::formatId(char *out, OrderId id)
+{
+    std::memcpy(out, WirePrefix.data(), WirePrefix.size());
+    char digits[20];
+    std::size_t n = 0;
+    do
+    {
+        digits[n++] = static_cast<char>('0' + id % 10);
+        id /= 10;
+    } while (id != 0);
+    char *p = out + WirePrefix.size();
+    while (n > 0)
+        *p++ = digits[--n];
+    return static_cast<std::size_t>(p - out);
+}
+
+OrderId OrderStore::parseId(std::string_view wire, std::string_view *suffix)
+{
+    if (wire.size() <= WirePrefix.size() || wire.compare(0, WirePrefix.size(), WirePrefix) != 0)
+        return InvalidOrderId;
+    std::size_t i = WirePrefix.size();
+    OrderId id = 0;
+    std::size_t digits = 0;
+    for (; i < wire.size() && wire[i] >= '0' && wire[i] <= '9'; ++i, ++digits)
+    {
+        const OrderId digit = static_cast<OrderId>(wire[i] - '0');
+        if (id > (std::numeric_limits<OrderId>::max() - digit) / 10)
+            return InvalidOrderId;
+        id = id * 10 + digit;
+    }
+    if (digits == 0)
+        return InvalidOrderId;
+    if (i < wire.size())
+    {
+        if (wire[i] != '_' || !suffix)
+            return InvalidOrderId;
+        *suffix = wire.substr(i + 1);
+    }
+    else if (suffix)
+    {
+        *suffix = std::string_view();
+    }
+    return id;
+}
@@ -1,21 +1,33 @@
 #include <PairsMeanReversionStrategy.hpp>
+#include <LatencyTrace.hpp>
+#include <Log.hpp>
 #include <cmath>
 #include <limits>
-#include <iostream>
 
-PairsMeanReversionStrategy::PairsMeanReversionStrategy(OrderManager &om, RiskManager &rm, std::string symbolA, std::string symbolB, double beta, size_t window, double entryZ, double exitZ)
-    : om(om), rm(rm), stats(window), symbolA(std::move(symbolA)), symbolB(std::move(symbolB)), beta(beta), entryZ(entryZ), exitZ(exitZ),
+PairsMeanReversionStrategy::PairsMeanReversionStrategy(OrderManager &om, RiskManager &rm, SymbolId symbolA, SymbolId symbolB, double beta, size_t window, double entryZ, double exitZ)
+    : om(om), rm(rm), stats(window), symbolA(symbolA), symbolB(symbolB), beta(beta),
+      quantityA(Fixed::fromDouble(1.0)), quantityB(Fixed::fromDouble(beta)), entryZ(entryZ), exitZ(exitZ),
       lastPriceA(std::numeric_limits<double>::quiet_NaN()), lastPriceB(std::numeric_limits<double>::quiet_NaN()) {}
 
 void PairsMeanReversionStrategy::onMarketData(const MarketData::Update &update)
 {
-    if (update.symbol == symbolA)
+    onMid(update.symbol, update.midPrice());
+}
+
+void PairsMeanReversionStrategy::onTopOfBook(const MarketData::TopOfBook &tob)
+{
+    onMid(tob.symbol, tob.midPrice());
+}
+
+void PairsMeanReversionStrategy::onMid(SymbolId symbol, double mid)
+{
+    if (symbol == symbolA)
     {
-        lastPriceA = update.midPrice();
+        lastPriceA = mid;
     }
-    else if (update.symbol == symbolB)
+    else if (symbol == symbolB)
     {
-        lastPriceB = update.midPrice();
+        lastPriceB = mid;
     }
     else
     {
@@ -44,36 +56,38 @@ void PairsMeanReversionStrategy::generateSignals(double z, double priceA, double
 {
     if (z < -entryZ)
     {
+        HFT_TRACE_STAGE(Signal);
         // long spread, buy A, sell B
-        attemptTrade(symbolA, OrderSide::BUY, 1.0, priceA);
-        attemptTrade(symbolB, OrderSide::SELL, beta, priceB);
+        attemptPair({symbolA, OrderSide::BUY, quantityA, Fixed::fromDouble(priceA)},
+                    {symbolB, OrderSide::SELL, quantityB, Fixed::fromDouble(priceB)});
     }
     else if (z > entryZ)
     {
+        HFT_TRACE_STAGE(Signal);
         // short spread sell A, buy B
-        attemptTrade(symbolA, OrderSide::SELL, 1.0, priceA);
-        attemptTrade(symbolB, OrderSide::BUY, beta, priceB);
+        attemptPair({symbolA, OrderSide::SELL, quantityA, Fixed::fromDouble(priceA)},
+                    {symbolB, OrderSide::BUY, quantityB, Fixed::fromDouble(priceB)});
     }
 }
 
-void PairsMeanReversionStrategy::attemptTrade(const std::string &sym, OrderSide side, double qty, double price)
+void PairsMeanReversionStrategy::attemptPair(const OrderRequest &legA, const OrderRequest &legB)
 {
-    Order o;
-    // add a symbol field for order struct in the future so that risk manager knows
-    o.clientId = "";
-    o.side = side;
-    o.quantity = qty;
-    o.price = price;
-    o.status = OrderStatus::NEW;
-    o.symbol=sym;
-    // add risk manager here
+    // sit the signal out rather than queue legs the exchange's order window cannot take yet,
+    // the next one will carry a fresher price anyway
+    if (om.orderHeadroom() < 2)
+        return;
+
+    // both legs or neither, one leg alone is an outright position rather than a spread
+    const OrderRequest legs[2] = {legA, legB};
     std::string reason;
-    if (rm.approve(sym, side, qty, price, reason))
-    {
-        om.sendOrder(side, qty, price, sym);
-    }
-    else
+    if (!rm.approve(legs, 2, reason))
     {
-        std::cerr << "risk rejected: " << reason << "\n";
+        HFT_LOG_WARN("risk rejected: {}", reason);
+        return;
     }
-}
\ No newline at end of file
+    HFT_TRACE_STAGE(RiskApproved);
+
+    // one submission, so the legs leave back to back
+    OrderId ids[2];
+    om.sendOrders(legs, 2, ids);
+}
@@ -1,24 +1,50 @@
 #include <RiskManager.hpp>
-#include <iostream>
+#include <Log.hpp>
 
-RiskManager::RiskManager(OrderManager &om, double maxPositionPerSymbol, double maxTotalNotional)
-    : om(om), maxPos(maxPositionPerSymbol), maxNotional(maxTotalNotional), notionalTraded(0.0)
+RiskManager::RiskManager(OrderManager &om, const SymbolRegistry &registry, Fixed maxPositionPerSymbol, Fixed maxTotalNotional)
+    : om(om), registry(registry), maxPos(maxPositionPerSymbol), maxNotional(maxTotalNotional), positions(registry.size()), notionalTraded()
 {
-    om.onOrderUpdate([this](const Order &ord)
-                     { this->onOrderUpdate(ord); });
+    om.orderEvents().subscribe(*this);
 }
 
-bool RiskManager::approve(const std::string &symbol, OrderSide side, double quantity, double price, std::string &reason)
+bool RiskManager::approve(SymbolId symbol, OrderSide side, Fixed quantity, Fixed price, std::string &reason)
 {
+    const OrderRequest leg{symbol, side, quantity, price};
+    return approve(&leg, 1, reason);
+}
+
+bool RiskManager::approve(const OrderRequest *legs, std::size_t n, std::string &reason)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (legs[i].symbol >= positions.size())
+        {
+            reason = "unknown symbol id " + std::to_string(legs[i].symbol);
+            return false;
+        }
+    }
     std::lock_guard lock(mu);
-    double sign = (side == OrderSide::BUY ? +1.0 : -1.0);
-    double newPos = positions[symbol] + sign * quantity;
-    double orderNot = std::abs(quantity * price);
-    double newNotion = notionalTraded + orderNot;
-    if (std::abs(newPos) > maxPos)
+    Fixed newNotion = notionalTraded;
+    for (std::size_t i = 0; i < n; ++i)
     {
-        reason = "position limit exceeded for " + symbol;
-        return false;
+        newNotion += abs(notional(legs[i].price, legs[i].quantity));
+        // first leg of each symbol sums every leg on it, later ones were already counted
+        bool counted = false;
+        for (std::size_t j = 0; j < i && !counted; ++j)
+            counted = legs[j].symbol == legs[i].symbol;
+        if (counted)
+            continue;
+        Fixed newPos = positions[legs[i].symbol];
+        for (std::size_t j = i; j < n; ++j)
+        {
+            if (legs[j].symbol == legs[i].symbol)
+                newPos = legs[j].side == OrderSide::BUY ? newPos + legs[j].quantity : newPos - legs[j].quantity;
+        }
+        if (abs(newPos) > maxPos)
+        {
+            reason = "position limit exceeded for " + registry.name(legs[i].symbol);
+            return false;
+        }
     }
     if (newNotion > maxNotional)
     {
@@ -30,15 +56,16 @@ bool RiskManager::approve(const std::string &symbol, OrderSide side, double quan
 
 void RiskManager::onOrderUpdate(const Order &ord)
 {
-    if (ord.status == OrderStatus::FILLED || ord.status == OrderStatus::PARTIAL)
+    if ((ord.status == OrderStatus::FILLED || ord.status == OrderStatus::PARTIAL) && ord.symbol < positions.size())
     {
         std::lock_guard lock(mu);
-        double sign = (ord.side == OrderSide::BUY ? +1.0 : -1.0);
-
-        positions[ord.symbol] += sign * ord.lastFillQuantity;
-        notionalTraded += std::abs(ord.lastFillQuantity * ord.lastFillPrice);
+        if (ord.side == OrderSide::BUY)
+            positions[ord.symbol] += ord.lastFillQuantity;
+        else
+            positions[ord.symbol] -= ord.lastFillQuantity;
+        notionalTraded += abs(notional(ord.lastFillPrice, ord.lastFillQuantity));
 
-        std::cout << "RiskManager " << ord.clientId << " fill " << ord.lastFillQuantity << " at " << ord.lastFillPrice << " position in " << ord.symbol << ": " << positions[ord.symbol]
-                  << ", total notional: " << notionalTraded << "\n";
+        HFT_LOG_INFO("RiskManager {} fill {} at {} position in {}: {}, total notional: {}", ord.id, ord.lastFillQuantity,
+                     ord.lastFillPrice, registry.name(ord.symbol), positions[ord.symbol], notionalTraded);
     }
 }
\ No newline at end of file
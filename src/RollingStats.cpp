@@ -1,5 +1,6 @@
 
 #include <RollingStats.hpp>
+#include <stdexcept>
 //helper to retrieve mean and stddev easily
 RollingStats::RollingStats(size_t window) : window(window), sum(0.0), sumSq(0.0) {
     if (window == 0) {
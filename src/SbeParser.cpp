@@ -0,0 +1,247 @@
+#include <SbeParser.hpp>
+#include <cstring>
+#include <string_view>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "SBE fields are read as little-endian host integers");
+
+namespace
+{
+    using TemplateId = SbeParser::TemplateId;
+
+    // bounds-checked little-endian reads over one message
+    class Reader
+    {
+    public:
+        Reader(const char *data, std::size_t size) : p(data), end(data + size) {}
+
+        template <typename T>
+        bool read(T &out)
+        {
+            if (static_cast<std::size_t>(end - p) < sizeof(T))
+                return false;
+            std::memcpy(&out, p, sizeof(T));
+            p += sizeof(T);
+            return true;
+        }
+
+        bool skip(std::size_t n)
+        {
+            if (static_cast<std::size_t>(end - p) < n)
+                return false;
+            p += n;
+            return true;
+        }
+
+        // varString8: uint8 length, then the bytes
+        bool readString(std::string_view &out)
+        {
+            uint8_t length = 0;
+            if (!read(length) || static_cast<std::size_t>(end - p) < length)
+                return false;
+            out = std::string_view(p, length);
+            p += length;
+            return true;
+        }
+
+        const char *position() const { return p; }
+        bool seek(const char *to)
+        {
+            if (to < p || to > end)
+                return false;
+            p = to;
+            return true;
+        }
+
+    private:
+        const char *p;
+        const char *end;
+    };
+
+    // mantissa * 10^exponent as Fixed units, false unless exact and in range
+    bool toFixed(int64_t mantissa, int exponent, Fixed &out)
+    {
+        static constexpr int64_t Pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+                                            1000000000, 10000000000, 100000000000, 1000000000000,
+                                            10000000000000, 100000000000000, 1000000000000000,
+                                            10000000000000000, 100000000000000000, 1000000000000000000};
+        const int shift = exponent + static_cast<int>(Fixed::Decimals);
+        if (shift >= 0)
+        {
+            if (shift > 18)
+            {
+                out = Fixed();
+                return mantissa == 0;
+            }
+            return !__builtin_mul_overflow(mantissa, Pow10[shift], &out.units);
+        }
+        if (-shift > 18)
+        {
+            out = Fixed();
+            return mantissa == 0;
+        }
+        const int64_t divisor = Pow10[-shift];
+        if (mantissa % divisor != 0)
+            return false;
+        out.units = mantissa / divisor;
+        return true;
+    }
+
+    // header for the expected template, the reader is left at the start of the fixed block
+    bool open(Reader &reader, const char *data, std::size_t size, TemplateId expected, SbeParser::Header &header)
+    {
+        return SbeParser::readHeader(data, size, header) && header.templateId == static_cast<uint16_t>(expected) &&
+               reader.skip(SbeParser::HeaderSize);
+    }
+
+    // repeating group of (price, quantity) mantissas, groupSize16Encoding
+    template <typename Fn>
+    bool readLevels(Reader &reader, int8_t priceExponent, int8_t qtyExponent, Fn &&emit)
+    {
+        uint16_t blockLength = 0;
+        uint16_t count = 0;
+        if (!reader.read(blockLength) || !reader.read(count) || blockLength < 16)
+            return false;
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            const char *entry = reader.position();
+            int64_t price = 0;
+            int64_t quantity = 0;
+            PriceLevel level;
+            if (!reader.read(price) || !reader.read(quantity) || !toFixed(price, priceExponent, level.price) ||
+                !toFixed(quantity, qtyExponent, level.quantity) || !reader.seek(entry + blockLength))
+                return false;
+            emit(level);
+        }
+        return true;
+    }
+
+    bool readSymbol(Reader &reader, const SymbolRegistry &registry, SymbolId &out)
+    {
+        std::string_view name;
+        if (!reader.readString(name))
+            return false;
+        out = registry.find(name);
+        return out != InvalidSymbol;
+    }
+}
+
+bool SbeParser::readHeader(const char *data, std::size_t size, Header &out)
+{
+    if (size < HeaderSize)
+        return false;
+    std::memcpy(&out.blockLength, data, 2);
+    std::memcpy(&out.templateId, data + 2, 2);
+    std::memcpy(&out.schemaId, data + 4, 2);
+    std::memcpy(&out.version, data + 6, 2);
+    return out.schemaId == SchemaId;
+}
+
+bool SbeParser::parseBestBidAsk(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::TopOfBook &out)
+{
+    Reader reader(data, size);
+    Header header;
+    if (!open(reader, data, size, TemplateId::BestBidAsk, header))
+        return false;
+    const char *block = reader.position();
+    int64_t eventTime = 0;
+    int8_t priceExponent = 0;
+    int8_t qtyExponent = 0;
+    int64_t bidPrice = 0, bidQty = 0, askPrice = 0, askQty = 0;
+    if (!reader.read(eventTime) || !reader.read(out.updateId) || !reader.read(priceExponent) || !reader.read(qtyExponent) ||
+        !reader.read(bidPrice) || !reader.read(bidQty) || !reader.read(askPrice) || !reader.read(askQty) ||
+        !reader.seek(block + header.blockLength))
+        return false;
+    return toFixed(bidPrice, priceExponent, out.bid.price) && toFixed(bidQty, qtyExponent, out.bid.quantity) &&
+           toFixed(askPrice, priceExponent, out.ask.price) && toFixed(askQty, qtyExponent, out.ask.quantity) &&
+           readSymbol(reader, registry, out.symbol);
+}
+
+bool SbeParser::parseDepthSnapshot(const char *data, std::size_t size, const SymbolRegistry &registry, MarketData::Update &out)
+{
+    Reader reader(data, size);
+    Header header;
+    if (!open(reader, data, size, TemplateId::DepthSnapshot, header))
+        return false;
+    const char *block = reader.position();
+    int64_t eventTime = 0;
+    int64_t updateId = 0;
+    int8_t priceExponent = 0;
+    int8_t qtyExponent = 0;
+    if (!reader.read(eventTime) || !reader.read(updateId) || !reader.read(priceExponent) || !reader.read(qtyExponent) ||
+        !reader.seek(block + header.blockLength))
+        return false;
+    out.bids.clear();
+    out.asks.clear();
+    // depth20 carries more than an Update holds, the rest is validated and dropped
+    auto into = [](MarketData::Levels &side)
+    {
+        return [&side](const PriceLevel &level)
+        {
+            if (!side.full())
+                side.push_back(level);
+        };
+    };
+    return readLevels(reader, priceExponent, qtyExponent, into(out.bids)) &&
+           readLevels(reader, priceExponent, qtyExponent, into(out.asks)) &&
+           readSymbol(reader, registry, out.symbol) && !out.bids.empty() && !out.asks.empty();
+}
+
+bool SbeParser::parseDepthDiff(const char *data, std::size_t size, const SymbolRegistry &registry, DepthDiff &out)
+{
+    Reader reader(data, size);
+    Header header;
+    if (!open(reader, data, size, TemplateId::DepthDiff, header))
+        return false;
+    const char *block = reader.position();
+    int64_t eventTime = 0;
+    int8_t priceExponent = 0;
+    int8_t qtyExponent = 0;
+    if (!reader.read(eventTime) || !reader.read(out.firstUpdateId) || !reader.read(out.lastUpdateId) ||
+        !reader.read(priceExponent) || !reader.read(qtyExponent) || !reader.seek(block + header.blockLength))
+        return false;
+    out.prevUpdateId = -1;
+    out.bids.clear();
+    out.asks.clear();
+    return readLevels(reader, priceExponent, qtyExponent, [&out](const PriceLevel &level)
+                      { out.bids.push_back(level); }) &&
+           readLevels(reader, priceExponent, qtyExponent, [&out](const PriceLevel &level)
+                      { out.asks.push_back(level); }) &&
+           readSymbol(reader, registry, out.symbol);
+}
+
+bool SbeParser::parseTrades(const char *data, std::size_t size, const SymbolRegistry &registry, SbeTrades &out)
+{
+    Reader reader(data, size);
+    Header header;
+    if (!open(reader, data, size, TemplateId::Trades, header))
+        return false;
+    const char *block = reader.position();
+    int64_t transactTime = 0;
+    int8_t priceExponent = 0;
+    int8_t qtyExponent = 0;
+    if (!reader.read(out.eventTimeUs) || !reader.read(transactTime) || !reader.read(priceExponent) ||
+        !reader.read(qtyExponent) || !reader.seek(block + header.blockLength))
+        return false;
+
+    // groupSizeEncoding: uint16 blockLength, uint32 numInGroup
+    uint16_t blockLength = 0;
+    uint32_t count = 0;
+    if (!reader.read(blockLength) || !reader.read(count) || blockLength < 25)
+        return false;
+    out.trades.clear();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const char *entry = reader.position();
+        SbeTrade trade;
+        int64_t price = 0;
+        int64_t quantity = 0;
+        uint8_t buyerMaker = 0;
+        if (!reader.read(trade.id) || !reader.read(price) || !reader.read(quantity) || !reader.read(buyerMaker) ||
+            !toFixed(price, priceExponent, trade.price) || !toFixed(quantity, qtyExponent, trade.quantity) ||
+            !reader.seek(entry + blockLength))
+            return false;
+        trade.buyerMaker = buyerMaker != 0;
+        out.trades.push_back(trade);
+    }
+    return readSymbol(reader, registry, out.symbol);
+}
@@ -0,0 +1,73 @@
+#include <SnapshotSource.hpp>
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace asio = boost::asio;
+namespace ssl = boost::asio::ssl;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = asio::ip::tcp;
+
+FileSnapshotSource::FileSnapshotSource(std::string dir) : dir(std::move(dir)) {}
+
+bool FileSnapshotSource::fetch(const std::string &symbol, std::string &body)
+{
+    std::ifstream in(dir + "/" + symbol + ".json", std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "snapshot file missing for " << symbol << " in " << dir << "\n";
+        return false;
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    body = ss.str();
+    return true;
+}
+
+RestSnapshotSource::RestSnapshotSource(ssl::context &ssl_ctx, std::string host, std::string port, std::string path, int limit)
+    : ssl_ctx(ssl_ctx), host(std::move(host)), port(std::move(port)), path(std::move(path)), limit(limit) {}
+
+bool RestSnapshotSource::fetch(const std::string &symbol, std::string &body)
+{
+    try
+    {
+        asio::io_context ioc;
+        tcp::resolver resolver(ioc);
+        beast::ssl_stream<beast::tcp_stream> stream(ioc, ssl_ctx);
+        if (!SSL_set_tlsext_host_name(stream.native_handle(), host.c_str()))
+        {
+            std::cerr << "Failed to set SNI hostname\n";
+        }
+        beast::get_lowest_layer(stream).expires_after(std::chrono::seconds(5));
+        beast::get_lowest_layer(stream).connect(resolver.resolve(host, port));
+        stream.handshake(ssl::stream_base::client);
+
+        http::request<http::empty_body> req{http::verb::get, path + "?symbol=" + symbol + "&limit=" + std::to_string(limit), 11};
+        req.set(http::field::host, host);
+        req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        http::write(stream, req);
+
+        beast::flat_buffer buffer;
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res);
+        if (res.result() != http::status::ok)
+        {
+            std::cerr << "snapshot request for " << symbol << " failed: " << res.result_int() << "\n";
+            return false;
+        }
+        body = std::move(res.body());
+
+        beast::error_code ec;
+        stream.shutdown(ec);
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "snapshot request error for " << symbol << ": " << e.what() << "\n";
+        return false;
+    }
+}
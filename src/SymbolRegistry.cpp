@@ -0,0 +1,98 @@
+#include <SymbolRegistry.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    char upper(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+
+    char lower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // decimals needed to print a multiple of the step, 0.01 -> 2
+    uint8_t decimalsOf(Fixed step)
+    {
+        uint8_t decimals = Fixed::Decimals;
+        for (int64_t u = step.units; decimals > 0 && u % 10 == 0; u /= 10)
+            --decimals;
+        return decimals;
+    }
+}
+
+SymbolId SymbolRegistry::add(std::string_view name)
+{
+    SymbolId existing = find(name);
+    if (existing != InvalidSymbol)
+    {
+        return existing;
+    }
+    if (names.size() >= InvalidSymbol)
+    {
+        throw std::length_error("symbol registry full");
+    }
+    std::string upperName(name);
+    std::string lowerName(name);
+    for (auto &c : upperName)
+        c = upper(c);
+    for (auto &c : lowerName)
+        c = lower(c);
+    names.push_back(std::move(upperName));
+    streamNames.push_back(std::move(lowerName));
+    infos.emplace_back();
+    return static_cast<SymbolId>(names.size() - 1);
+}
+
+SymbolId SymbolRegistry::find(std::string_view name) const
+{
+    // a handful of symbols per engine, a linear scan beats hashing here
+    for (std::size_t id = 0; id < names.size(); ++id)
+    {
+        const std::string &candidate = names[id];
+        if (candidate.size() != name.size())
+            continue;
+        std::size_t i = 0;
+        while (i < name.size() && candidate[i] == upper(name[i]))
+            ++i;
+        if (i == name.size())
+            return static_cast<SymbolId>(id);
+    }
+    return InvalidSymbol;
+}
+
+const std::string &SymbolRegistry::name(SymbolId id) const
+{
+    return names.at(id);
+}
+
+const std::string &SymbolRegistry::streamName(SymbolId id) const
+{
+    return streamNames.at(id);
+}
+
+std::size_t SymbolRegistry::size() const
+{
+    return names.size();
+}
+
+void SymbolRegistry::setFilters(SymbolId id, Fixed tickSize, Fixed lotSize)
+{
+    if (tickSize.units <= 0 || lotSize.units <= 0)
+    {
+        throw std::invalid_argument("tick and lot size have to be positive for " + name(id));
+    }
+    SymbolInfo &info = infos.at(id);
+    info.tickSize = tickSize;
+    info.lotSize = lotSize;
+    info.priceDecimals = decimalsOf(tickSize);
+    info.quantityDecimals = decimalsOf(lotSize);
+}
+
+const SymbolInfo &SymbolRegistry::info(SymbolId id) const
+{
+    return infos.at(id);
+}
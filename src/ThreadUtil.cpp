@@ -0,0 +1,88 @@
+#include <ThreadUtil.hpp>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+
+namespace
+{
+    bool pinHandle(pthread_t handle, int core)
+    {
+        if (core < 0)
+            return true;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        int rc = pthread_setaffinity_np(handle, sizeof(set), &set);
+        if (rc != 0)
+        {
+            std::cerr << "cannot pin thread to core " << core << ": " << std::strerror(rc) << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool scheduleHandle(pthread_t handle, ThreadUtil::Scheduling policy, int priority)
+    {
+        int native = SCHED_OTHER;
+        if (policy == ThreadUtil::Scheduling::Fifo)
+            native = SCHED_FIFO;
+        else if (policy == ThreadUtil::Scheduling::RoundRobin)
+            native = SCHED_RR;
+        else
+            priority = 0;
+        sched_param param{};
+        param.sched_priority = priority;
+        int rc = pthread_setschedparam(handle, native, &param);
+        if (rc != 0)
+        {
+            std::cerr << "cannot set scheduling policy " << native << " priority " << priority << ": "
+                      << std::strerror(rc) << "\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+bool ThreadUtil::pin(std::thread &thread, int core)
+{
+    return pinHandle(thread.native_handle(), core);
+}
+
+bool ThreadUtil::pinCurrent(int core)
+{
+    return pinHandle(pthread_self(), core);
+}
+
+bool ThreadUtil::setScheduling(std::thread &thread, Scheduling policy, int priority)
+{
+    return scheduleHandle(thread.native_handle(), policy, priority);
+}
+
+bool ThreadUtil::setSchedulingCurrent(Scheduling policy, int priority)
+{
+    return scheduleHandle(pthread_self(), policy, priority);
+}
+
+ThreadUtil::Scheduling ThreadUtil::parseScheduling(const std::string &name)
+{
+    if (name == "normal")
+        return Scheduling::Normal;
+    if (name == "fifo")
+        return Scheduling::Fifo;
+    if (name == "rr")
+        return Scheduling::RoundRobin;
+    throw std::invalid_argument("unknown scheduling policy " + name + ", expected normal, fifo or rr");
+}
+
+ThreadUtil::Idle ThreadUtil::parseIdle(const std::string &name)
+{
+    if (name == "pause")
+        return Idle::Pause;
+    if (name == "yield")
+        return Idle::Yield;
+    if (name == "sleep")
+        return Idle::Sleep;
+    throw std::invalid_argument("unknown idle policy " + name + ", expected pause, yield or sleep");
+}
@@ -0,0 +1,365 @@
+#include <WsConnection.hpp>
+#include <Log.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <sys/socket.h>
+
+namespace
+{
+    int64_t steadyNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+WsConnection::WsConnection(Executor executor, ssl::context &sslCtx, std::string host, std::string port, std::string name)
+    : executor(executor), sslCtx(sslCtx), host(std::move(host)), port(std::move(port)), name(std::move(name)),
+      resolver(executor), retryTimer(executor) {}
+
+WsConnection::~WsConnection()
+{
+    if (tlsSession)
+        SSL_SESSION_free(tlsSession);
+}
+
+void WsConnection::setSettings(const Settings &s)
+{
+    settings = s;
+}
+
+void WsConnection::addHeader(std::string field, std::string value)
+{
+    headers.emplace_back(std::move(field), std::move(value));
+}
+
+void WsConnection::onTarget(std::function<std::string()> cb)
+{
+    targetCallback = std::move(cb);
+}
+
+void WsConnection::onOpen(std::function<void(bool)> cb)
+{
+    openCallback = std::move(cb);
+}
+
+void WsConnection::onFrame(std::function<void(const char *, std::size_t)> cb)
+{
+    frameCallback = std::move(cb);
+}
+
+void WsConnection::onClose(std::function<void()> cb)
+{
+    closeCallback = std::move(cb);
+}
+
+void WsConnection::start()
+{
+    if (running.exchange(true))
+        return;
+    backoffMs = settings.reconnectMinMs;
+    asio::post(executor, [this]
+               { connect(); });
+}
+
+void WsConnection::stop(std::function<void()> done)
+{
+    running = false;
+    asio::post(executor, [this, done = std::move(done)]()
+               {
+        retryTimer.cancel();
+        resolver.cancel();
+        const bool wasOpen = open;
+        open = false;
+        ++sessionGeneration;
+        std::shared_ptr<Stream> s = current;
+        if (!s)
+        {
+            if (done)
+                done();
+            return;
+        }
+        if (!wasOpen)
+        {
+            beast::error_code ec;
+            beast::get_lowest_layer(*s).close(ec);
+            if (done)
+                done();
+            return;
+        }
+        s->async_close(ws::close_code::normal, [s, done](beast::error_code)
+                       {
+            beast::error_code ec;
+            beast::get_lowest_layer(*s).shutdown(tcp::socket::shutdown_both, ec);
+            beast::get_lowest_layer(*s).close(ec);
+            if (done)
+                done(); }); });
+}
+
+bool WsConnection::stopAndWait(std::chrono::milliseconds timeout)
+{
+    if (!running)
+        return true;
+    auto closed = std::make_shared<std::promise<void>>();
+    std::future<void> done = closed->get_future();
+    stop([closed]
+         { closed->set_value(); });
+    if (done.wait_for(timeout) == std::future_status::ready)
+        return true;
+    HFT_LOG_WARN("{}: session did not close within {} ms", name, timeout.count());
+    return false;
+}
+
+WsConnection::Stats WsConnection::stats() const
+{
+    return Stats{connects.load(std::memory_order_relaxed), disconnects.load(std::memory_order_relaxed),
+                 resumedSessions.load(std::memory_order_relaxed), lastOutageNs.load(std::memory_order_relaxed),
+                 maxOutageNs.load(std::memory_order_relaxed), frames.load(std::memory_order_relaxed),
+                 frameBytes.load(std::memory_order_relaxed), largestFrame.load(std::memory_order_relaxed),
+                 bufferGrowths.load(std::memory_order_relaxed), bytesCopied.load(std::memory_order_relaxed)};
+}
+
+void WsConnection::connect()
+{
+    if (!running)
+        return;
+    // a fresh stream per attempt, the old one stays alive for as long as its handlers hold it
+    current = std::make_shared<Stream>(executor, sslCtx);
+    // clear() keeps the storage; twice the largest frame leaves room for a frame and the next header
+    buffer.clear();
+    buffer.reserve(std::max<std::size_t>(settings.frameBuffer, 2 * largestFrame.load(std::memory_order_relaxed)));
+    resolver.async_resolve(host, port, beast::bind_front_handler(&WsConnection::onResolve, this, sessionGeneration));
+}
+
+void WsConnection::onResolve(uint64_t gen, beast::error_code ec, tcp::resolver::results_type results)
+{
+    if (gen != sessionGeneration)
+        return;
+    if (ec)
+        return fail("resolve", ec);
+    endpoints = std::move(results);
+    connectTo(gen, endpoints.begin());
+}
+
+void WsConnection::connectTo(uint64_t gen, tcp::resolver::results_type::const_iterator it)
+{
+    // endpoints one by one instead of asio::async_connect, the socket has to be open to take options
+    tcp::socket &socket = beast::get_lowest_layer(*current);
+    beast::error_code ec;
+    socket.close(ec);
+    socket.open(it->endpoint().protocol(), ec);
+    if (ec)
+        return fail("socket", ec);
+    applySocketOptions(socket);
+    socket.async_connect(it->endpoint(), [this, gen, it](beast::error_code ec)
+                         { onConnect(gen, it, ec); });
+}
+
+void WsConnection::applySocketOptions(tcp::socket &socket)
+{
+    beast::error_code ec;
+    if (settings.noDelay)
+    {
+        socket.set_option(tcp::no_delay(true), ec);
+        if (ec)
+            HFT_LOG_WARN("{}: cannot set TCP_NODELAY: {}", name, ec.message());
+    }
+    if (settings.receiveBuffer > 0)
+    {
+        socket.set_option(asio::socket_base::receive_buffer_size(settings.receiveBuffer), ec);
+        if (ec)
+            HFT_LOG_WARN("{}: cannot set SO_RCVBUF: {}", name, ec.message());
+    }
+    if (settings.sendBuffer > 0)
+    {
+        socket.set_option(asio::socket_base::send_buffer_size(settings.sendBuffer), ec);
+        if (ec)
+            HFT_LOG_WARN("{}: cannot set SO_SNDBUF: {}", name, ec.message());
+    }
+#ifdef SO_BUSY_POLL
+    if (settings.busyPollMicros > 0)
+    {
+        const int micros = settings.busyPollMicros;
+        if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &micros, sizeof(micros)) != 0)
+            HFT_LOG_WARN("{}: cannot set SO_BUSY_POLL: {}", name, std::strerror(errno));
+    }
+#else
+    if (settings.busyPollMicros > 0)
+        HFT_LOG_WARN("{}: SO_BUSY_POLL is not available on this platform", name);
+#endif
+}
+
+void WsConnection::onConnect(uint64_t gen, tcp::resolver::results_type::const_iterator it, beast::error_code ec)
+{
+    if (gen != sessionGeneration)
+        return;
+    if (ec)
+    {
+        if (++it != endpoints.end())
+            return connectTo(gen, it);
+        return fail("connect", ec);
+    }
+
+    SSL *ssl = current->next_layer().native_handle();
+    if (!SSL_set_tlsext_host_name(ssl, host.c_str()))
+        HFT_LOG_WARN("{}: failed to set SNI hostname", name);
+    if (tlsSession)
+        SSL_set_session(ssl, tlsSession);
+
+    current->next_layer().async_handshake(ssl::stream_base::client,
+                                          beast::bind_front_handler(&WsConnection::onTlsHandshake, this, gen));
+}
+
+void WsConnection::onTlsHandshake(uint64_t gen, beast::error_code ec)
+{
+    if (gen != sessionGeneration)
+        return;
+    if (ec)
+        return fail("tls handshake", ec);
+    if (SSL_session_reused(current->next_layer().native_handle()))
+        resumedSessions.fetch_add(1, std::memory_order_relaxed);
+    // tls 1.2 sessions are resumable from here, 1.3 tickets only arrive later, see keepTlsSession
+    keepTlsSession();
+
+    current->set_option(ws::stream_base::timeout::suggested(beast::role_type::client));
+    current->set_option(ws::stream_base::decorator([this](ws::request_type &req)
+                                                   {
+        req.set(beast::http::field::user_agent, std::string(BOOST_BEAST_VERSION_STRING) + " websocket-client-async-ssl");
+        for (const auto &[field, value] : headers)
+            req.set(field, value); }));
+    const std::string target = targetCallback ? targetCallback() : std::string("/");
+    current->async_handshake(host + ":" + port, target, beast::bind_front_handler(&WsConnection::onWsHandshake, this, gen));
+}
+
+void WsConnection::onWsHandshake(uint64_t gen, beast::error_code ec)
+{
+    if (gen != sessionGeneration)
+        return;
+    if (ec)
+        return fail("ws handshake", ec);
+
+    open = true;
+    backoffMs = settings.reconnectMinMs;
+    const bool reconnected = connects.fetch_add(1, std::memory_order_relaxed) != 0;
+    if (reconnected && lostAt != 0)
+    {
+        const auto outage = static_cast<uint64_t>(steadyNanos() - lostAt);
+        lastOutageNs.store(outage, std::memory_order_relaxed);
+        if (outage > maxOutageNs.load(std::memory_order_relaxed))
+            maxOutageNs.store(outage, std::memory_order_relaxed);
+        HFT_LOG_INFO("{}: reconnected after {} ms", name, static_cast<double>(outage) / 1e6);
+    }
+    else
+    {
+        HFT_LOG_INFO("{}: connected", name);
+    }
+    lostAt = 0;
+
+    if (openCallback)
+        openCallback(reconnected);
+    doRead();
+}
+
+void WsConnection::doRead()
+{
+    if (!open)
+        return;
+    readCapacity = buffer.capacity();
+    current->async_read(buffer, [this, s = current, gen = sessionGeneration](beast::error_code ec, std::size_t)
+                        { onRead(gen, ec); });
+}
+
+void WsConnection::onRead(uint64_t gen, beast::error_code ec)
+{
+    if (gen != sessionGeneration)
+        return;
+    if (ec)
+        return fail("read", ec);
+    if (!running)
+        return;
+    // flat_buffer keeps the frame contiguous, the owner parses it where it lies
+    const auto frame = buffer.data();
+    const uint64_t size = frame.size();
+    // one writer, plain stores
+    frames.store(frames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    frameBytes.store(frameBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    if (size > largestFrame.load(std::memory_order_relaxed))
+        largestFrame.store(size, std::memory_order_relaxed);
+    if (buffer.capacity() != readCapacity)
+    {
+        // a regrow copies what had arrived so far, at most the frame
+        bufferGrowths.store(bufferGrowths.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        bytesCopied.store(bytesCopied.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    }
+    if (frameCallback)
+        frameCallback(static_cast<const char *>(frame.data()), frame.size());
+    buffer.consume(buffer.size());
+    // the callback may have failed the session, e.g. on a write error
+    if (gen == sessionGeneration)
+        doRead();
+}
+
+void WsConnection::keepTlsSession()
+{
+    SSL_SESSION *session = SSL_get1_session(current->next_layer().native_handle());
+    if (session == nullptr)
+        return;
+    if (!SSL_SESSION_is_resumable(session))
+    {
+        SSL_SESSION_free(session);
+        return;
+    }
+    if (tlsSession)
+        SSL_SESSION_free(tlsSession);
+    tlsSession = session;
+}
+
+void WsConnection::fail(const char *what, beast::error_code ec)
+{
+    if (!running)
+        return;
+    const bool wasOpen = open;
+    open = false;
+    // every handler still queued on the old stream is now stale
+    ++sessionGeneration;
+    if (current)
+    {
+        keepTlsSession();
+        // openssl retires the session of a connection freed without close_notify; tls 1.1 and
+        // later allow resuming it anyway, so mark this one as shut down cleanly
+        SSL *ssl = current->next_layer().native_handle();
+        if (SSL_is_init_finished(ssl))
+            SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        beast::error_code ignored;
+        beast::get_lowest_layer(*current).close(ignored);
+    }
+    if (lostAt == 0)
+        lostAt = steadyNanos();
+
+    if (wasOpen)
+    {
+        disconnects.fetch_add(1, std::memory_order_relaxed);
+        HFT_LOG_WARN("{}: session lost ({}: {}), reconnecting", name, what, ec.message());
+        if (closeCallback)
+            closeCallback();
+    }
+    else
+    {
+        HFT_LOG_WARN("{}: {} failed: {}, retrying in {} ms", name, what, ec.message(), backoffMs);
+    }
+    scheduleReconnect();
+}
+
+void WsConnection::scheduleReconnect()
+{
+    retryTimer.expires_after(std::chrono::milliseconds(backoffMs));
+    backoffMs = std::min(std::max(backoffMs, 1) * 2, settings.reconnectMaxMs);
+    retryTimer.async_wait([this](beast::error_code ec)
+                          {
+        if (!ec && running)
+            connect(); });
+}
@@ -2,82 +2,264 @@
 #include "OrderManager.hpp"
 #include "PairsMeanReversionStrategy.hpp"
 #include "RiskManager.hpp"
+#include "SymbolRegistry.hpp"
+#include "MarketDataJournal.hpp"
+#include "EngineConfig.hpp"
+#include "SnapshotSource.hpp"
+#include "StrategyPipeline.hpp"
+#include "LatencyTrace.hpp"
+#include "Log.hpp"
+#include "ExecutionContext.hpp"
 #include <boost/asio.hpp>
 #include <chrono>
 #include <thread>
 #include <iostream>
 #include <vector>
 #include <string>
-#include <iomanip>
+#include <memory>
+#include <limits>
 
-int main()
+int main(int argc, char **argv)
 {
-    asio::io_context ioc;
+    // hft_engine [config.json], no file means the live binance defaults
+    EngineConfig config;
+    try
+    {
+        if (argc > 1)
+            config = EngineConfig::load(argv[1]);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    HFT_TRACE_INIT();
+
     ssl::context ctx{ssl::context::tlsv12_client};
     ctx.set_default_verify_paths();
-    ctx.set_verify_mode(ssl::verify_peer);
+    if (!config.caFile.empty())
+    {
+        ctx.load_verify_file(config.caFile);
+    }
+    ctx.set_verify_mode(config.verifyPeer ? ssl::verify_peer : ssl::verify_none);
 
-    std::vector<std::string> symbols = {"btcusdt", "ethusdt"};
+    // every symbol gets its dense id here, before any component sizes its per-symbol state
+    SymbolRegistry symbols;
+    std::vector<SymbolId> ids;
+    for (const auto &name : config.symbols)
+        ids.push_back(symbols.add(name));
+    // filters shape the order encoder's number formatting, so they go in before OrderManager exists
+    try
+    {
+        for (const auto &[name, f] : config.filters)
+        {
+            SymbolId id = symbols.find(name);
+            if (id == InvalidSymbol)
+            {
+                std::cerr << "filters for " << name << " ignored, not a configured symbol" << std::endl;
+                continue;
+            }
+            symbols.setFilters(id, f.tickSize, f.lotSize);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
-    MarketData md(ioc, ctx, "fstream.binance.com", "443", symbols);
+    // everything on the trading path logs through here, the console and file writes happen on the log thread
+    Log::Options logOptions;
+    logOptions.path = config.log.file;
+    logOptions.console = config.log.console;
+    try
+    {
+        Log::start(logOptions);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // thread topology: market data and order entry each on their own context, or both on one
+    auto contextOptions = [](const char *name, const EngineConfig::ThreadPlacement &placement)
+    {
+        ExecutionContext::Options options;
+        options.name = name;
+        options.core = placement.core;
+        options.scheduling = placement.scheduling;
+        options.priority = placement.priority;
+        options.spin = placement.spin;
+        return options;
+    };
+    ExecutionContext feedContext(contextOptions(config.threads.single ? "engine" : "market data", config.threads.marketData));
+    std::unique_ptr<ExecutionContext> orderContextOwned;
+    if (!config.threads.single)
+        orderContextOwned = std::make_unique<ExecutionContext>(contextOptions("order entry", config.threads.orders));
+    ExecutionContext &orderContext = orderContextOwned ? *orderContextOwned : feedContext;
+    if (config.threads.single && config.pipeline.enabled)
+    {
+        std::cerr << "single-threaded mode runs the strategy inline, pipeline disabled" << std::endl;
+        config.pipeline.enabled = false;
+    }
+
+    MarketData md(feedContext.context(), ctx, config.marketData.host, config.marketData.port, symbols, ids);
 
     //
-    OrderManager om(ioc, ctx, "testnet.binance.vision", "443"); 
-
-    RiskManager rm(om, 5.0, 500000.0);
-    PairsMeanReversionStrategy strategy(om, rm, "BTCUSDT", "ETHUSDT", 0.065, 20, 2.0, 0.5);
-
-    om.onOrderUpdate([](const Order &order)
-                     {
-        std::cout << "=== ORDER UPDATE ===" << std::endl;
-        std::cout << "ID: " << order.clientId << std::endl;
-        std::cout << "Symbol: " << order.symbol << std::endl;
-        std::cout << "Side: " << (order.side == OrderSide::BUY ? "BUY" : "SELL") << std::endl;
-        std::cout << "Quantity: " << order.quantity << std::endl;
-        std::cout << "Price: " << std::fixed << std::setprecision(4) << order.price << std::endl;
-        std::cout << "Status: ";
-        switch(order.status) {
-            case OrderStatus::NEW: std::cout << "NEW"; break;
-            case OrderStatus::ACKED: std::cout << "ACKNOWLEDGED"; break;
-            case OrderStatus::PARTIAL: std::cout << "PARTIALLY_FILLED"; break;
-            case OrderStatus::FILLED: std::cout << "FILLED"; break;
-            case OrderStatus::CANCELED: std::cout<<"CANCELED"; break;
-            case OrderStatus::REJECTED: std::cout << "REJECTED"; break;
+    OrderManager om(orderContext.context(), ctx, config.orders.host, config.orders.port, symbols); 
+
+    // both sessions share the socket tuning and the reconnect policy
+    WsConnection::Settings connectionSettings;
+    connectionSettings.noDelay = config.connection.noDelay;
+    connectionSettings.receiveBuffer = config.connection.receiveBuffer;
+    connectionSettings.sendBuffer = config.connection.sendBuffer;
+    connectionSettings.busyPollMicros = config.connection.busyPollMicros;
+    connectionSettings.reconnectMinMs = config.connection.reconnectMinMs;
+    connectionSettings.reconnectMaxMs = config.connection.reconnectMaxMs;
+    connectionSettings.frameBuffer = config.connection.frameBuffer;
+    md.setConnectionSettings(connectionSettings);
+    om.setConnectionSettings(connectionSettings);
+
+    RiskManager rm(om, symbols, Fixed::fromDouble(5.0), Fixed::fromDouble(500000.0));
+    PairsMeanReversionStrategy strategy(om, rm, ids[0], ids[1], 0.065, 20, 2.0, 0.5);
+
+    // trace of every order update, async so even the log call stays off the ack path
+    struct OrderLog : OrderListener
+    {
+        const SymbolRegistry &symbols;
+        explicit OrderLog(const SymbolRegistry &symbols) : symbols(symbols) {}
+
+        void onOrderUpdate(const Order &order) override
+        {
+            const char *status = "?";
+            switch(order.status) {
+                case OrderStatus::NEW: status = "NEW"; break;
+                case OrderStatus::ACKED: status = "ACKNOWLEDGED"; break;
+                case OrderStatus::PARTIAL: status = "PARTIALLY_FILLED"; break;
+                case OrderStatus::FILLED: status = "FILLED"; break;
+                case OrderStatus::CANCELED: status = "CANCELED"; break;
+                case OrderStatus::REJECTED: status = "REJECTED"; break;
+            }
+            HFT_LOG_INFO("order {} {} {} {} @ {} {} last fill {} at {}", order.id, symbols.name(order.symbol),
+                         order.side == OrderSide::BUY ? "BUY" : "SELL", order.quantity, order.price, status,
+                         order.lastFillQuantity, order.lastFillPrice);
         }
-        std::cout<<std::endl;
-        if (order.lastFillQuantity>0) {
-            std::cout <<"Last fill " << order.lastFillQuantity <<"at" << std::fixed << std::setprecision(4)<<order.lastFillPrice << std::endl;
+    } orderLog(symbols);
+    om.orderEvents().subscribeAsync(orderLog);
+
+    auto handleUpdate = [&strategy, &symbols](const MarketData::Update &update)
+    {
+        //log every 5th update
+        static int counter = 0;
+        if (++counter % 5 == 0 && !update.bids.empty() && !update.asks.empty()) {
+            HFT_LOG_INFO("{} mid {} bid {} ({}) ask {} ({}) spread {}", symbols.name(update.symbol), update.midPrice(),
+                         update.bids[0].price, update.bids[0].quantity, update.asks[0].price, update.asks[0].quantity,
+                         update.asks[0].price - update.bids[0].price);
         }
-        std::cout << "===================" << std::endl << std::endl; });
+        //get signal
+        strategy.onMarketData(update);
+    };
 
-    md.onUpdate([&strategy](const MarketData::Update &update)
-                {
+    auto handleTopOfBook = [&strategy, &symbols](const MarketData::TopOfBook &tob)
+    {
         //log every 5th update
         static int counter = 0;
         if (++counter % 5 == 0) {
-            std::cout << "=== MARKET DATA ===" << std::endl;
-            std::cout << "Symbol: " << update.symbol << std::endl;
-            std::cout << "Mid Price: " << std::fixed << std::setprecision(4) << update.midPrice() << std::endl;
-            
-            if (!update.bids.empty() && !update.asks.empty()) {
-                std::cout << "Best Bid: " << update.bids[0].price << " (" << update.bids[0].quantity << ")" << std::endl;
-                std::cout << "Best Ask: " << update.asks[0].price  << " (" << update.asks[0].quantity << ")" << std::endl;
-                std::cout << "Spread: " << std::fixed << std::setprecision(4) << (update.asks[0].price - update.bids[0].price) << std::endl;
-            }
-            std::cout << "===================" << std::endl << std::endl;
+            HFT_LOG_INFO("{} mid {} bid {} ({}) ask {} ({}) spread {}", symbols.name(tob.symbol), tob.midPrice(),
+                         tob.bid.price, tob.bid.quantity, tob.ask.price, tob.ask.quantity, tob.ask.price - tob.bid.price);
         }
         //get signal
-        strategy.onMarketData(update); });
+        strategy.onTopOfBook(tob);
+    };
+
+    // pipeline mode: the io thread only decodes and enqueues, the strategy runs on its own thread
+    using UpdatePipeline = StrategyPipeline<MarketData::Update>;
+    using TopOfBookPipeline = StrategyPipeline<MarketData::TopOfBook>;
+    std::unique_ptr<UpdatePipeline> updatePipeline;
+    std::unique_ptr<TopOfBookPipeline> topOfBookPipeline;
+    if (config.pipeline.enabled)
+    {
+        // threads.strategy places the pipeline thread, pipeline.core still works on its own
+        const int strategyCore = config.threads.strategy.core >= 0 ? config.threads.strategy.core : config.pipeline.core;
+        UpdatePipeline::Options updateOptions;
+        updateOptions.capacity = config.pipeline.capacity;
+        updateOptions.core = strategyCore;
+        updateOptions.scheduling = config.threads.strategy.scheduling;
+        updateOptions.priority = config.threads.strategy.priority;
+        updateOptions.conflate = config.pipeline.conflate;
+        updateOptions.symbols = symbols.size();
+        TopOfBookPipeline::Options topOfBookOptions;
+        topOfBookOptions.capacity = config.pipeline.capacity;
+        topOfBookOptions.core = strategyCore;
+        topOfBookOptions.scheduling = config.threads.strategy.scheduling;
+        topOfBookOptions.priority = config.threads.strategy.priority;
+        topOfBookOptions.conflate = config.pipeline.conflate;
+        topOfBookOptions.symbols = symbols.size();
+        updatePipeline = std::make_unique<UpdatePipeline>(handleUpdate, updateOptions);
+        topOfBookPipeline = std::make_unique<TopOfBookPipeline>(handleTopOfBook, topOfBookOptions);
+        md.onUpdate([&updatePipeline](const MarketData::Update &update)
+                    { updatePipeline->push(update); });
+        md.onTopOfBook([&topOfBookPipeline](const MarketData::TopOfBook &tob)
+                       { topOfBookPipeline->push(tob); });
+    }
+    else
+    {
+        md.onUpdate(handleUpdate);
+        md.onTopOfBook(handleTopOfBook);
+    }
+
+    // top-of-book strategies take the lighter bookTicker stream unless the config pins one
+    std::unique_ptr<SnapshotSource> snapshots;
+    if (config.feed == "depth5")
+    {
+        md.setFeed(MarketData::Feed::Depth5);
+    }
+    else if (config.feed == "diff")
+    {
+        if (config.snapshotDir.empty())
+            snapshots = std::make_unique<RestSnapshotSource>(ctx, config.snapshotRest.host, config.snapshotRest.port, config.snapshotPath);
+        else
+            snapshots = std::make_unique<FileSnapshotSource>(config.snapshotDir);
+        md.setFeed(MarketData::Feed::DiffDepth, snapshots.get());
+    }
+    else if (config.feed == "bookTicker" || strategy.requiredDepth() == Strategy::BookDepth::TopOfBook)
+    {
+        md.setFeed(MarketData::Feed::BookTicker);
+    }
+
+    if (config.encoding == "sbe")
+        md.setEncoding(MarketData::Encoding::Sbe, config.apiKey);
+
+    // every received frame goes to the journal for offline replay (md_replay)
+    std::unique_ptr<MarketDataJournal> journal;
+    if (!config.journal.empty())
+    {
+        journal = std::make_unique<MarketDataJournal>(config.journal, symbols);
+        md.record(journal.get());
+    }
 
     std::cout << "Starting!" << std::endl;
     std::cout << "risk limits: 5 units per crypto and 500k total notional" << std::endl;
 
+    // only one feed is live, so only one of the two strategy threads ever polls
+    if (config.pipeline.enabled)
+    {
+        if (md.currentFeed() == MarketData::Feed::BookTicker)
+            topOfBookPipeline->start();
+        else
+            updatePipeline->start();
+    }
+
+    feedContext.start();
+    orderContext.start();
     md.run();
     om.run();
 
     //display status
     int secondsRunning = 0;
-    while (true)
+    while (config.runSeconds == 0 || secondsRunning < config.runSeconds)
     {
         std::this_thread::sleep_for(std::chrono::seconds(1));
         secondsRunning++;
@@ -85,6 +267,87 @@ int main()
         if (secondsRunning % 5 == 0)
         {
             std::cout << "--- Status: Running for " << secondsRunning << " seconds ---" << std::endl;
+            if (config.pipeline.enabled)
+            {
+                auto stats = md.currentFeed() == MarketData::Feed::BookTicker ? topOfBookPipeline->stats() : updatePipeline->stats();
+                std::cout << "pipeline: depth " << stats.depth << " max " << stats.maxDepth
+                          << " pushed " << stats.pushed << " delivered " << stats.delivered
+                          << " overruns " << stats.overruns << " conflated " << stats.conflated << std::endl;
+                for (SymbolId id : ids)
+                {
+                    uint64_t conflated = md.currentFeed() == MarketData::Feed::BookTicker ? topOfBookPipeline->conflated(id) : updatePipeline->conflated(id);
+                    if (conflated != 0)
+                        std::cout << "  " << symbols.name(id) << " conflated " << conflated << std::endl;
+                }
+            }
+            OutboxStats outbox = om.outboxStats();
+            std::cout << "outbox: depth " << outbox.depth << " max " << outbox.maxDepth << " written " << outbox.written
+                      << " queued p50 " << outbox.queuedP50Ns / 1000.0 << "us p99 " << outbox.queuedP99Ns / 1000.0
+                      << "us max " << outbox.queuedMaxNs / 1000.0 << "us" << std::endl;
+            if (om.orderEvents().dropped() != 0)
+                std::cout << "order events dropped: " << om.orderEvents().dropped() << std::endl;
+            if (Log::dropped() != 0)
+                std::cout << "log records dropped: " << Log::dropped() << std::endl;
+            FeedStats feed = md.feedStats();
+            WsConnection::Stats orderSession = om.connectionStats();
+            if (feed.connection.disconnects != 0 || orderSession.disconnects != 0)
+            {
+                std::cout << "market data session: drops " << feed.connection.disconnects << " resumed tls "
+                          << feed.connection.resumedSessions << " last outage " << feed.connection.lastOutageNs / 1e6
+                          << "ms max " << feed.connection.maxOutageNs / 1e6 << "ms";
+                if (md.currentFeed() == MarketData::Feed::DiffDepth)
+                    std::cout << " missed updates " << feed.missedUpdates;
+                std::cout << std::endl;
+                std::cout << "order session: drops " << orderSession.disconnects << " resumed tls " << orderSession.resumedSessions
+                          << " last outage " << orderSession.lastOutageNs / 1e6 << "ms max " << orderSession.maxOutageNs / 1e6
+                          << "ms" << std::endl;
+            }
+            auto printSpin = [](const ExecutionContext &context)
+            {
+                if (!context.settings().spin.enabled)
+                    return;
+                ExecutionContext::Stats spin = context.stats();
+                std::cout << context.settings().name << " loop: polls " << spin.polls << " idle " << spin.idlePolls
+                          << " handlers " << spin.handlers << " backoffs " << spin.backoffs << std::endl;
+            };
+            printSpin(feedContext);
+            if (&orderContext != &feedContext)
+                printSpin(orderContext);
+            auto printReceive = [](const char *session, const WsConnection::Stats &stats)
+            {
+                if (stats.frames == 0)
+                    return;
+                std::cout << session << " receive: frames " << stats.frames << " avg " << stats.frameBytes / stats.frames
+                          << "B largest " << stats.largestFrame << "B buffer growths " << stats.bufferGrowths
+                          << " copied/frame " << static_cast<double>(stats.bytesCopied) / stats.frames << "B" << std::endl;
+            };
+            printReceive("market data", feed.connection);
+            printReceive("order", orderSession);
+            SchedulerStats scheduler = om.schedulerStats();
+            std::cout << "scheduler: queued " << scheduler.queued << " superseded " << scheduler.superseded
+                      << " throttled " << scheduler.throttled << " headroom ";
+            if (scheduler.orderHeadroom == std::numeric_limits<std::size_t>::max())
+                std::cout << "unknown" << std::endl;
+            else
+                std::cout << scheduler.orderHeadroom << std::endl;
+            HFT_TRACE_REPORT(std::cout);
         }
     }
-}
\ No newline at end of file
+
+    md.stop();
+    if (updatePipeline)
+    {
+        updatePipeline->stop();
+        topOfBookPipeline->stop();
+    }
+    om.stop();
+    orderContext.stop();
+    feedContext.stop();
+    if (journal)
+    {
+        journal->stop();
+    }
+    Log::stop();
+    HFT_TRACE_REPORT(std::cout);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "ExchangeSimulator.hpp"
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// local exchange for end-to-end runs of hft_engine
+// usage: exchange_sim [--port <p>] [--cert-out <pem>] [--journal <file>] [--symbols A,B]
+//                     [--interval-us <n>] [--duration <s>] [--no-fill] [--drop-every <s>]
+int main(int argc, char **argv)
+{
+    ExchangeSimulator::Options options;
+    int durationSeconds = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        auto arg = [&](const char *name)
+        { return std::strcmp(argv[i], name) == 0 && i + 1 < argc; };
+        if (arg("--port"))
+            options.port = static_cast<unsigned short>(std::stoi(argv[++i]));
+        else if (arg("--address"))
+            options.address = argv[++i];
+        else if (arg("--cert-out"))
+            options.certOut = argv[++i];
+        else if (arg("--journal"))
+            options.journal = argv[++i];
+        else if (arg("--interval-us"))
+            options.intervalUs = std::stoi(argv[++i]);
+        else if (arg("--drop-every"))
+            options.dropEverySeconds = std::stoi(argv[++i]);
+        else if (arg("--duration"))
+            durationSeconds = std::stoi(argv[++i]);
+        else if (arg("--symbols"))
+        {
+            options.symbols.clear();
+            std::stringstream ss(argv[++i]);
+            std::string symbol;
+            while (std::getline(ss, symbol, ','))
+                options.symbols.push_back(symbol);
+        }
+        else if (std::strcmp(argv[i], "--no-fill") == 0)
+            options.fill = false;
+        else
+        {
+            std::cerr << "unknown argument " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    boost::asio::io_context ioc;
+    ExchangeSimulator sim(ioc, options);
+    sim.start();
+
+    boost::asio::signal_set signals(ioc, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code &, int)
+                       { sim.stop(); });
+    boost::asio::steady_timer deadline(ioc);
+    if (durationSeconds > 0)
+    {
+        deadline.expires_after(std::chrono::seconds(durationSeconds));
+        deadline.async_wait([&](const boost::system::error_code &ec)
+                            {
+            if (!ec)
+                sim.stop(); });
+    }
+
+    ioc.run();
+    sim.report(std::cout);
+    return 0;
+}
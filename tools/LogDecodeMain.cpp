@@ -0,0 +1,14 @@
+#include "Log.hpp"
+#include <iostream>
+
+// offline decoder for the engine's binary log, one text line per entry in timestamp order
+// usage: log_decode <log file>
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <log file>\n";
+        return 1;
+    }
+    return Log::decode(argv[1], std::cout) ? 0 : 1;
+}
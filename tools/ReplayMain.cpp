@@ -0,0 +1,103 @@
+#include "JournalReplay.hpp"
+#include "Log.hpp"
+#include "MarketData.hpp"
+#include "OrderManager.hpp"
+#include "PairsMeanReversionStrategy.hpp"
+#include "RiskManager.hpp"
+#include "SymbolRegistry.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// offline driver: replays a market data journal into MarketData and, optionally, the strategy
+// usage: md_replay <journal> [--paced] [--speed <x>] [--strategy]
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <journal> [--paced] [--speed <x>] [--strategy]\n";
+        return 1;
+    }
+    auto pacing = JournalReplay::Pacing::AsFastAsPossible;
+    double speed = 1.0;
+    bool withStrategy = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--paced") == 0)
+            pacing = JournalReplay::Pacing::Recorded;
+        else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            speed = std::stod(argv[++i]);
+        else if (std::strcmp(argv[i], "--strategy") == 0)
+            withStrategy = true;
+    }
+
+    JournalReplay replay(argv[1]);
+
+    // ids come back in recorded order, so they match what the journal holds
+    SymbolRegistry symbols;
+    std::vector<SymbolId> ids;
+    for (const auto &name : replay.symbols())
+        ids.push_back(symbols.add(name));
+
+    // never run, MarketData and OrderManager only need them to exist
+    asio::io_context ioc;
+    ssl::context ctx{ssl::context::tlsv12_client};
+    MarketData md(ioc, ctx, "", "", symbols, ids);
+    md.setFeed(replay.feed(), &replay);
+    md.setEncoding(replay.encoding());
+
+    uint64_t updates = 0;
+    double checksum = 0.0;
+    md.onUpdate([&](const MarketData::Update &update)
+                {
+        ++updates;
+        checksum += update.midPrice(); });
+    md.onTopOfBook([&](const MarketData::TopOfBook &tob)
+                   {
+        ++updates;
+        checksum += tob.midPrice(); });
+
+    std::unique_ptr<OrderManager> om;
+    std::unique_ptr<RiskManager> rm;
+    std::unique_ptr<PairsMeanReversionStrategy> strategy;
+    if (withStrategy)
+    {
+        if (ids.size() < 2)
+        {
+            std::cerr << "--strategy needs at least two recorded symbols\n";
+            return 1;
+        }
+        om = std::make_unique<OrderManager>(ioc, ctx, "", "", symbols);
+        rm = std::make_unique<RiskManager>(*om, symbols, Fixed::fromDouble(5.0), Fixed::fromDouble(500000.0));
+        strategy = std::make_unique<PairsMeanReversionStrategy>(*om, *rm, ids[0], ids[1], 0.065, 20, 2.0, 0.5);
+        md.onUpdate([&](const MarketData::Update &update)
+                    {
+            ++updates;
+            strategy->onMarketData(update); });
+        md.onTopOfBook([&](const MarketData::TopOfBook &tob)
+                       {
+            ++updates;
+            strategy->onTopOfBook(tob); });
+    }
+
+    std::cout << "replaying " << argv[1] << " (" << replay.symbols().size() << " symbols, "
+              << (pacing == JournalReplay::Pacing::Recorded ? "recorded pacing" : "full speed") << ")" << std::endl;
+
+    // per-order logging would dominate the profile: with the strategy the log is never started,
+    // so HFT_LOG_* calls return straight away
+    if (!withStrategy)
+        Log::start(Log::Options{});
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t records = replay.run(md, pacing, speed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Log::stop();
+
+    std::cout << records << " records, " << updates << " updates in " << seconds << " s, "
+              << static_cast<uint64_t>(updates / (seconds > 0 ? seconds : 1e-9)) << " updates/s"
+              << " (checksum " << checksum << ")" << std::endl;
+    return 0;
+}